@@ -0,0 +1,572 @@
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+#include "tri_tri_kernel.h"
+#include "exact_kernel.h"
+#include "fixed_decimal.h"
+#include "text_scene.h"
+#include "simd_level.h"
+
+using namespace geometry;
+
+//Benchmarks of narrow phase checks and of whole searches on example and generated scenes.
+//Results are printed to stdout as one JSON object, progress goes to stderr.
+//Kernels are checked against the reference check first, exit code is 1 if they differ.
+//Usage: bench [--examples dir] [--max-size objects_num] [--quick]
+
+namespace {
+
+const int MICRO_REPEATS = 5;
+const int SCENE_REPEATS = 3;
+const size_t MICRO_OBJECTS_NUM = 1024;
+
+//results are summed here, so compiler can't drop checks
+volatile size_t sink = 0;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+//the best of repeats, run() returns number of hits
+template <typename F>
+double best_seconds(int repeats, F run) {
+    double best = std::numeric_limits<double>::max();
+    for(int k = 0; k < repeats; ++k) {
+        const auto start = std::chrono::steady_clock::now();
+        sink = sink + run();
+        best = std::min(best, seconds_since(start));
+    }
+    return best;
+}
+
+//-----------------------------------Random_Objects--------------------------------
+
+class Random_Objects final {
+private:
+    std::mt19937_64 gen_;
+    std::uniform_real_distribution<double> coord_;
+    std::uniform_real_distribution<double> shift_;
+public:
+    //objects are in cube [0, area_size] and their points are closer than object_size
+    Random_Objects(uint64_t seed, double area_size, double object_size):
+        gen_(seed), coord_(0.0, object_size), shift_(0.0, area_size) {}
+
+    point gen_point() {
+        return point(coord_(gen_), coord_(gen_), coord_(gen_));
+    }
+    vec gen_shift() {
+        return vec(shift_(gen_), shift_(gen_), shift_(gen_));
+    }
+
+    Triangle gen_triangle() {
+        while(true) {
+            const vec shift = gen_shift();
+            const point p1 = gen_point() + shift, p2 = gen_point() + shift, p3 = gen_point() + shift;
+            if(!is_points_match(p1, p2) && !is_points_match(p1, p3) &&
+               !is_points_on_one_line(p1, p2, p3)) return Triangle(p1, p2, p3);
+        }
+    }
+    Cut gen_cut() {
+        while(true) {
+            const vec shift = gen_shift();
+            const point p1 = gen_point() + shift, p2 = gen_point() + shift;
+            if(!is_points_match(p1, p2)) return Cut(p1, p2);
+        }
+    }
+    point gen_shifted_point() {
+        return gen_point() + gen_shift();
+    }
+    Undefined_Object gen_object() {
+        const Triangle t = gen_triangle();
+        return Undefined_Object(t.p1(), t.p2(), t.p3());
+    }
+};
+
+//-----------------------------------Micro_Benchmarks------------------------------
+
+struct Micro_Result {
+    std::string name;
+    double ns_per_check;
+    double hit_rate;
+};
+
+//every object of first set is checked with every object of second set
+template <typename T1, typename T2, typename F>
+Micro_Result micro_benchmark(const std::string& name, const std::vector<T1>& objs1,
+                             const std::vector<T2>& objs2, F check) {
+    size_t hits = 0;
+    const double time = best_seconds(MICRO_REPEATS, [&]() {
+        hits = 0;
+        for(const T1& obj1 : objs1) {
+            for(const T2& obj2 : objs2) hits += check(obj1, obj2) ? 1 : 0;
+        }
+        return hits;
+    });
+    const double checks_num = static_cast<double>(objs1.size() * objs2.size());
+    std::cerr << "micro " << name << std::endl;
+    return Micro_Result{name, time * 1e9 / checks_num, hits / checks_num};
+}
+
+std::vector<Micro_Result> run_micro_benchmarks(size_t objects_num) {
+    //area is small enough for a part of pairs to intersect
+    Random_Objects gen(1, 10.0, 5.0);
+    std::vector<Triangle> triangles;
+    std::vector<Cut> cuts;
+    std::vector<point> points;
+    for(size_t i = 0; i < objects_num; ++i) {
+        triangles.push_back(gen.gen_triangle());
+        cuts.push_back(gen.gen_cut());
+        points.push_back(gen.gen_shifted_point());
+    }
+    //random points almost never touch anything, so half of them are taken from other objects
+    std::vector<point> near_points;
+    for(size_t i = 0; i < objects_num; ++i) {
+        if(i % 4 == 1) near_points.push_back(triangles[i].p1());
+        else if(i % 4 == 3) near_points.push_back(cuts[i].p_begin());
+        else near_points.push_back(points[i]);
+    }
+
+    std::vector<Triangle_Coords> coords;
+    std::vector<Triangle_Cache> caches;
+    std::vector<const Triangle_Coords*> candidates;
+    for(const Triangle& t : triangles) coords.push_back(make_triangle_coords(t));
+    for(const Triangle_Coords& t : coords) {
+        caches.push_back(make_triangle_cache(t));
+        candidates.push_back(&t);
+    }
+
+    //projections of triangles to xy plane, degenerate projections are skipped
+    std::vector<Triangle_2d> triangles_2d;
+    std::vector<Cut_2d> cuts_2d;
+    std::vector<point_2d> points_2d;
+    for(size_t i = 0; i < objects_num; ++i) {
+        const Triangle& t = triangles[i];
+        try {
+            triangles_2d.push_back(Triangle_2d(point_2d(t.p1().x(), t.p1().y()),
+                                               point_2d(t.p2().x(), t.p2().y()),
+                                               point_2d(t.p3().x(), t.p3().y())));
+            cuts_2d.push_back(Cut_2d(point_2d(t.p1().x(), t.p1().y()),
+                                     point_2d(t.p2().x(), t.p2().y())));
+        }
+        catch(const std::invalid_argument&) {
+            continue;
+        }
+        points_2d.push_back(point_2d(points[i].x(), points[i].y()));
+    }
+
+    using G = Geometry_Object;
+    std::vector<Micro_Result> results;
+    results.push_back(micro_benchmark("check_intersection/triangle_triangle", triangles, triangles,
+            [](const Triangle& t1, const Triangle& t2) { return G::check_intersection(t1, t2); }));
+    results.push_back(micro_benchmark("check_intersection/triangle_cut", triangles, cuts,
+            [](const Triangle& t, const Cut& c) { return G::check_intersection(t, c); }));
+    results.push_back(micro_benchmark("check_intersection/triangle_point", triangles, near_points,
+            [](const Triangle& t, const point& p) { return G::check_intersection(t, p); }));
+    results.push_back(micro_benchmark("check_intersection/cut_cut", cuts, cuts,
+            [](const Cut& c1, const Cut& c2) { return G::check_intersection(c1, c2); }));
+    results.push_back(micro_benchmark("check_intersection/cut_point", cuts, near_points,
+            [](const Cut& c, const point& p) { return G::check_intersection(c, p); }));
+    results.push_back(micro_benchmark("check_intersection/point_point", near_points, near_points,
+            [](const point& p1, const point& p2) { return G::check_intersection(p1, p2); }));
+
+    //kernel with caches, as finders call it
+    std::vector<size_t> numbers(objects_num);
+    for(size_t i = 0; i < objects_num; ++i) numbers[i] = i;
+    results.push_back(micro_benchmark("kernel/triangles_cached", numbers, coords,
+            [&](size_t i, const Triangle_Coords& t2) {
+        return is_triangles_intersects(coords[i], caches[i], t2);
+    }));
+    {
+        std::vector<uint8_t> packet_results(objects_num);
+        size_t hits = 0;
+        const double time = best_seconds(MICRO_REPEATS, [&]() {
+            hits = 0;
+            for(size_t i = 0; i < objects_num; ++i) {
+                is_triangles_intersects_packet(coords[i], caches[i], candidates.data(),
+                                               candidates.size(), packet_results.data());
+                for(uint8_t result : packet_results) hits += result;
+            }
+            return hits;
+        });
+        const double checks_num = static_cast<double>(objects_num * objects_num);
+        std::cerr << "micro kernel/triangles_packet" << std::endl;
+        results.push_back(Micro_Result{"kernel/triangles_packet", time * 1e9 / checks_num,
+                                       hits / checks_num});
+    }
+    results.push_back(micro_benchmark("kernel/triangles_exact", coords, coords,
+            [](const Triangle_Coords& t1, const Triangle_Coords& t2) {
+        return is_triangles_intersects_exact(t1.v, t2.v);
+    }));
+
+    results.push_back(micro_benchmark("2d/is_cut_2d_intersects", cuts_2d, cuts_2d,
+            [](const Cut_2d& c1, const Cut_2d& c2) { return is_cut_2d_intersects(c1, c2); }));
+    results.push_back(micro_benchmark("2d/is_in_triangle", triangles_2d, points_2d,
+            [](const Triangle_2d& t, const point_2d& p) { return t.is_in_triangle(p); }));
+    return results;
+}
+
+//--------------------------------------Self_Check---------------------------------
+
+const size_t CHECK_PACKETS_NUM = 2500;
+//candidates of one triangle are checked by one call, so all vector lanes are used
+const size_t CHECK_PACKET_SIZE = 8;
+
+struct Check_Result {
+    std::string name;
+    size_t pairs_num;
+    size_t hits;       //by the reference check
+    size_t mismatches; //of any kernel with the reference check
+};
+
+//triangle and candidates of one kind
+struct Check_Packet {
+    Triangle t;
+    std::vector<Triangle> candidates;
+};
+
+double dot(const vec& v1, const vec& v2) {
+    return v1.x() * v2.x() + v1.y() * v2.y() + v1.z() * v2.z();
+}
+
+vec unit(vec v) {
+    v.normalize();
+    return v;
+}
+
+//point p1 + a * (p2 - p1) + b * (p3 - p1) of the triangle plane
+point plane_point(const Triangle& t, double a, double b) {
+    return t.p1() + a * vec(t.p1(), t.p2()) + b * vec(t.p1(), t.p3());
+}
+
+//Triangle which crosses plane of t by a cut going out of t through a side.
+//The cut starts at distance gap from the side along the cut (negative gap is inside t),
+//angles between the cut and the side are down to 0.001, there 2d tolerance of the side
+//covers a long part of the cut.
+Triangle near_triangle(const Triangle& t, double gap, std::mt19937_64& gen) {
+    std::uniform_real_distribution<double> part(0.0, 1.0);
+    const point vertexes[3] = {t.p1(), t.p2(), t.p3()};
+    const size_t side = gen() % 3;
+    const point& begin = vertexes[side];
+    const point& end = vertexes[(side + 1) % 3];
+    const point& opposite = vertexes[(side + 2) % 3];
+
+    const vec normal = t.pl().normal();
+    const vec along = unit(vec(begin, end));
+    const point on_side = begin + part(gen) * vec(begin, end);
+    vec out = mult_vec(along, normal);
+    if(dot(out, vec(on_side, opposite)) > 0) out = -1.0 * out;
+
+    const double sin_angle = std::pow(10.0, -3.0 * part(gen));
+    const double cos_angle = std::sqrt(1 - sin_angle * sin_angle) * ((gen() % 2 == 0) ? 1 : -1);
+    const vec dir = cos_angle * along + sin_angle * out;
+    //the triangle plane goes through dir, it's turned from normal of t by tilt
+    const double tilt = 1.2 * (2 * part(gen) - 1);
+    const vec up = std::cos(tilt) * normal + std::sin(tilt) * mult_vec(normal, dir);
+
+    const point start = on_side + gap * dir;
+    return Triangle(start + (0.5 + 2 * part(gen)) * up, start + (-0.5 - 2 * part(gen)) * up,
+                    start + (0.5 + 4 * part(gen)) * dir + (2 * part(gen) - 1) * up);
+}
+
+//triangle with the third point almost on the line of the first two
+Triangle gen_sliver(Random_Objects& gen, std::mt19937_64& gen_part) {
+    std::uniform_real_distribution<double> part(-0.5, 1.5);
+    std::uniform_real_distribution<double> sliver_part(0.0, 1e-4);
+    while(true) {
+        const Triangle t = gen.gen_triangle();
+        const point end = t.p1() + part(gen_part) * vec(t.p1(), t.p2()) +
+                          sliver_part(gen_part) * vec(t.p1(), t.p3());
+        try {
+            return Triangle(t.p1(), t.p2(), end);
+        }
+        catch(const std::invalid_argument&) {}
+    }
+}
+
+//Side of t goes at angle 0.0275 to the line where planes meet, candidates are in the plane
+//turned by 0.1 about x and their cuts start at gaps from the side along the line.
+//Vector lanes took the cut at gap 17e-6 as a miss, but 2d tolerance of the side covers it.
+Check_Packet tilted_near_misses() {
+    const double gaps[CHECK_PACKET_SIZE] = {-1e-5, 0, 1e-6, 1e-5, 17e-6, 3e-5, 1e-4, 1e-3};
+    const double c = std::cos(0.1), s = std::sin(0.1);
+    Check_Packet packet{Triangle(point(-1, -0.1, 0), point(3, 0.01, 0), point(-1, 1, 0)), {}};
+    for(double gap : gaps) {
+        const double x = -1 + 4 * (0.1 / 0.11) + gap;
+        packet.candidates.push_back(Triangle(point(x, -c, -s), point(x, c, s),
+                                             point(5, 0.5 * c, 0.5 * s)));
+    }
+    return packet;
+}
+
+//kinds of pairs, degenerate cases and cases on the border of tolerance
+//are where kernels can take different branches
+std::vector<std::vector<Check_Packet>> gen_check_packets(size_t packets_num) {
+    //area is smaller than for micro benchmarks, so a lot of pairs intersect
+    Random_Objects gen(2, 3.0, 5.0);
+    std::mt19937_64 gen_part(3);
+    std::uniform_real_distribution<double> part(-0.5, 1.5);
+    std::uniform_real_distribution<double> gap_log10(-8.0, -3.0);
+
+    std::vector<std::vector<Check_Packet>> packets(7);
+    for(size_t i = 0; i < packets_num; ++i) {
+        const Triangle t = gen.gen_triangle();
+        //slivers are checked with random candidates
+        const Triangle sliver = gen_sliver(gen, gen_part);
+        std::vector<Triangle> kinds[7];
+        //candidates which happen to be degenerate are skipped
+        while(kinds[0].size() < CHECK_PACKET_SIZE) {
+            const double gap = std::pow(10.0, gap_log10(gen_part)) * ((gen_part() % 2 == 0) ? 1 : -1);
+            try {
+                //order of points is random, so normals are opposite in a half of coplanar pairs
+                const Triangle candidates[7] = {
+                    gen.gen_triangle(),
+                    Triangle(plane_point(t, part(gen_part), part(gen_part)),
+                             plane_point(t, part(gen_part), part(gen_part)),
+                             plane_point(t, part(gen_part), part(gen_part))),
+                    Triangle(t.p2(), t.p1(), gen.gen_shifted_point()),
+                    Triangle(gen.gen_shifted_point(), t.p3(), gen.gen_shifted_point()),
+                    gen.gen_triangle(),
+                    near_triangle(t, gap, gen_part),
+                    near_triangle(t, 0.0, gen_part)};
+                for(int kind = 0; kind < 7; ++kind) kinds[kind].push_back(candidates[kind]);
+            }
+            catch(const std::invalid_argument&) {}
+        }
+        for(size_t kind = 0; kind < packets.size(); ++kind) {
+            packets[kind].push_back(Check_Packet{(kind == 4) ? sliver : t, kinds[kind]});
+        }
+    }
+    packets[5].push_back(tilted_near_misses());
+    return packets;
+}
+
+//the reference check of triangles against kernels which finders use,
+//packets are checked on every level of vector instructions of this processor
+std::vector<Check_Result> run_self_checks(size_t packets_num) {
+    const char* const names[7] = {"random", "coplanar", "shared_edge", "shared_vertex", "sliver",
+                                  "near_miss", "touching"};
+    const std::vector<std::vector<Check_Packet>> packets = gen_check_packets(packets_num);
+    std::vector<simd_level> levels;
+    for(simd_level level : {SCALAR_SIMD, AVX2_SIMD, AVX512_SIMD}) {
+        if(level <= best_simd_level()) levels.push_back(level);
+    }
+
+    std::vector<Check_Result> results;
+    for(size_t kind = 0; kind < packets.size(); ++kind) {
+        Check_Result result{names[kind], 0, 0, 0};
+        for(const Check_Packet& packet : packets[kind]) {
+            const Triangle_Coords t = make_triangle_coords(packet.t);
+            const Triangle_Cache cache = make_triangle_cache(t);
+            const size_t count = packet.candidates.size();
+            std::vector<Triangle_Coords> coords;
+            std::vector<const Triangle_Coords*> candidates;
+            for(const Triangle& candidate : packet.candidates) {
+                coords.push_back(make_triangle_coords(candidate));
+            }
+            for(const Triangle_Coords& candidate : coords) candidates.push_back(&candidate);
+
+            std::vector<std::vector<uint8_t>> packet_results(levels.size(),
+                                                             std::vector<uint8_t>(count));
+            for(size_t l = 0; l < levels.size(); ++l) {
+                is_triangles_intersects_packet(t, cache, candidates.data(), count,
+                                               packet_results[l].data(), levels[l]);
+            }
+
+            for(size_t k = 0; k < count; ++k) {
+                const bool expected = Geometry_Object::check_intersection_reference(
+                            packet.t, packet.candidates[k]);
+                bool is_same = (is_triangles_intersects(t, coords[k]) == expected) &&
+                               (is_triangles_intersects(t, cache, coords[k]) == expected);
+                for(const std::vector<uint8_t>& level_results : packet_results) {
+                    is_same = is_same && ((level_results[k] != 0) == expected);
+                }
+                ++result.pairs_num;
+                result.hits += expected ? 1 : 0;
+                result.mismatches += is_same ? 0 : 1;
+            }
+        }
+        std::cerr << "self check " << result.name << ": " << result.mismatches
+                  << " mismatches of " << result.pairs_num << std::endl;
+        results.push_back(result);
+    }
+    return results;
+}
+
+//------------------------------------Scene_Benchmarks-----------------------------
+
+struct Scene {
+    std::string name;
+    std::vector<Undefined_Object> objects;
+};
+
+struct Scene_Result {
+    std::string scene;
+    size_t objects_num;
+    std::string engine;
+    size_t threads_num;
+    double storage_seconds;
+    double search_seconds;
+    size_t intersecting_num; //it must not change between versions
+};
+
+//format of input_examples: objects number, then 9 coordinates of every object
+Scene read_scene(const std::string& file_name) {
+    Scene scene;
+    scene.name = file_name.substr(file_name.find_last_of("/\\") + 1);
+    scene.objects = read_text_scene(file_name);
+    return scene;
+}
+
+//density of triangles_generator scenes: 2000 triangles of size 5 in cube 50
+Scene generate_scene(size_t objects_num) {
+    const double area_size = 50.0 * std::cbrt(objects_num / 2000.0);
+    Random_Objects gen(objects_num, area_size, 5.0);
+
+    Scene scene;
+    scene.name = "generated_" + std::to_string(objects_num);
+    scene.objects.reserve(objects_num);
+    for(size_t i = 0; i < objects_num; ++i) {
+        scene.objects.push_back(gen.gen_object());
+    }
+    return scene;
+}
+
+std::vector<Scene_Result> run_scene_benchmarks(const std::vector<Scene>& scenes) {
+    const int ENGINES_NUM = 6;
+    const finder_engine engines[ENGINES_NUM] = {PLANE_SPLIT_ENGINE, BVH_ENGINE, GRID_ENGINE,
+                                                PLANE_SPLIT_ENGINE, PLANE_SPLIT_ENGINE,
+                                                PLANE_SPLIT_ENGINE};
+    const predicate_kind predicates[ENGINES_NUM] = {TOLERANCE_PREDICATES, TOLERANCE_PREDICATES,
+                                                    TOLERANCE_PREDICATES, EXACT_PREDICATES,
+                                                    TOLERANCE_PREDICATES, INTEGER_PREDICATES};
+    const scalar_kind scalars[ENGINES_NUM] = {DOUBLE_SCALAR, DOUBLE_SCALAR, DOUBLE_SCALAR,
+                                              DOUBLE_SCALAR, FLOAT_SCALAR, DOUBLE_SCALAR};
+    const char* const engine_names[ENGINES_NUM] = {"plane_split", "bvh", "grid", "plane_split_exact",
+                                                   "plane_split_float", "plane_split_integer"};
+    const size_t threads[2] = {1, 0};
+
+    std::vector<Scene_Result> results;
+    for(const Scene& scene : scenes) {
+        //integer predicates are measured only for scenes with fixed decimal digits
+        const int digits = detect_decimal_digits(scene.objects);
+        const std::vector<Undefined_Object> grid_objects =
+                (digits >= 0) ? to_decimal_grid(scene.objects, digits) : std::vector<Undefined_Object>();
+
+        for(int e = 0; e < ENGINES_NUM; ++e) {
+            const bool is_on_grid = (predicates[e] == INTEGER_PREDICATES);
+            if(is_on_grid && (digits < 0)) continue;
+
+            for(size_t threads_num : threads) {
+                Finder_Settings settings;
+                settings.engine = engines[e];
+                settings.predicates = predicates[e];
+                settings.scalar = scalars[e];
+                settings.threads_num = threads_num;
+
+                Scene_Result result{scene.name, scene.objects.size(), engine_names[e], threads_num,
+                                    std::numeric_limits<double>::max(),
+                                    std::numeric_limits<double>::max(), 0};
+                for(int k = 0; k < SCENE_REPEATS; ++k) {
+                    auto start = std::chrono::steady_clock::now();
+                    Geometry_Object_Storage objects(is_on_grid ? grid_objects : scene.objects);
+                    result.storage_seconds = std::min(result.storage_seconds, seconds_since(start));
+
+                    start = std::chrono::steady_clock::now();
+                    Intersection_Finder finder(std::move(objects), settings);
+                    Objects_and_Intersections answer = finder.compute_intersections();
+                    result.search_seconds = std::min(result.search_seconds, seconds_since(start));
+
+                    const std::vector<bool>& flags = answer.intersection_flags();
+                    result.intersecting_num = std::count(flags.begin(), flags.end(), true);
+                }
+                std::cerr << "scene " << scene.name << " " << engine_names[e]
+                          << " threads " << threads_num << std::endl;
+                results.push_back(result);
+            }
+        }
+    }
+    return results;
+}
+
+void write_json(std::ostream& out, const std::vector<Check_Result>& checks,
+                const std::vector<Micro_Result>& micro, const std::vector<Scene_Result>& scenes) {
+    out << "{\n  \"self_check\": [";
+    for(size_t k = 0; k < checks.size(); ++k) {
+        out << (k > 0 ? "," : "") << "\n    {\"name\": \"" << checks[k].name
+            << "\", \"checks\": " << checks[k].pairs_num << ", \"hits\": " << checks[k].hits
+            << ", \"mismatches\": " << checks[k].mismatches << "}";
+    }
+    out << "\n  ],\n  \"micro\": [";
+    for(size_t k = 0; k < micro.size(); ++k) {
+        out << (k > 0 ? "," : "") << "\n    {\"name\": \"" << micro[k].name
+            << "\", \"ns_per_check\": " << micro[k].ns_per_check
+            << ", \"hit_rate\": " << micro[k].hit_rate << "}";
+    }
+    out << "\n  ],\n  \"scenes\": [";
+    for(size_t k = 0; k < scenes.size(); ++k) {
+        const Scene_Result& r = scenes[k];
+        out << (k > 0 ? "," : "") << "\n    {\"scene\": \"" << r.scene
+            << "\", \"objects\": " << r.objects_num << ", \"engine\": \"" << r.engine
+            << "\", \"threads\": " << r.threads_num << ", \"storage_seconds\": " << r.storage_seconds
+            << ", \"search_seconds\": " << r.search_seconds
+            << ", \"intersecting\": " << r.intersecting_num << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} //namespace
+
+int main(int argc, char** argv) {
+    std::string examples_dir = "input_examples";
+    size_t max_size = 100000;
+    bool is_quick = false; //smaller micro benchmarks for fast checks
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if((arg == "--examples") && (i + 1 < argc)) examples_dir = argv[++i];
+        else if((arg == "--max-size") && (i + 1 < argc)) max_size = std::stoul(argv[++i]);
+        else if(arg == "--quick") is_quick = true;
+        else {
+            std::cerr << "usage: bench [--examples dir] [--max-size objects_num] [--quick]" << std::endl;
+            return 1;
+        }
+    }
+
+    //kernels must agree with the reference check before they are measured
+    const std::vector<Check_Result> checks = run_self_checks(is_quick ? CHECK_PACKETS_NUM / 4
+                                                                      : CHECK_PACKETS_NUM);
+    bool is_checked = true;
+    for(const Check_Result& check : checks) is_checked = is_checked && (check.mismatches == 0);
+
+    std::vector<Micro_Result> micro = run_micro_benchmarks(is_quick ? MICRO_OBJECTS_NUM / 4
+                                                                    : MICRO_OBJECTS_NUM);
+
+    std::vector<Scene> scenes;
+    const char* const examples[] = {"input_example1.txt", "input_example2.txt", "input_example3.txt",
+                                    "input_example5.txt", "input_example6.txt", "input_example7.txt"};
+    for(const char* example : examples) {
+        try {
+            scenes.push_back(read_scene(examples_dir + "/" + example));
+        }
+        catch(const std::invalid_argument& e) {
+            std::cerr << e.what() << ", it's skipped" << std::endl;
+        }
+    }
+    for(size_t size = 1000; size <= max_size; size *= 10) {
+        scenes.push_back(generate_scene(size));
+    }
+
+    write_json(std::cout, checks, micro, run_scene_benchmarks(scenes));
+    return is_checked ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bipartite_finder.h"
+#include "bvh.h"
+#include "fixed_decimal.h"
+
+namespace geometry {
+
+namespace {
+
+std::vector<Bounding_Box> objects_boxes(const Geometry_Object_Storage& objects,
+                                        const std::vector<Stored_Object_Ref>& refs) {
+    std::vector<Bounding_Box> boxes;
+    boxes.reserve(refs.size());
+    for(Stored_Object_Ref ref : refs) {
+        boxes.push_back(stored_object_box(objects, ref.type, ref.index));
+    }
+    return boxes;
+}
+
+std::vector<bool> load_flags(const std::vector<std::atomic<bool>>& flags) {
+    std::vector<bool> answer(flags.size());
+    for(size_t k = 0; k < flags.size(); ++k) {
+        answer[k] = flags[k].load(std::memory_order_relaxed);
+    }
+    return answer;
+}
+
+} //namespace
+
+Bipartite_Finder::Bipartite_Finder(Geometry_Object_Storage first_objects,
+                                   Geometry_Object_Storage second_objects,
+                                   Finder_Settings settings):
+    first_objects_(std::move(first_objects)),
+    second_objects_(std::move(second_objects)),
+    settings_(settings),
+    first_flags_(first_objects_.capacity()),
+    second_flags_(second_objects_.capacity())
+{
+    for(std::atomic<bool>& flag : first_flags_) flag.store(false, std::memory_order_relaxed);
+    for(std::atomic<bool>& flag : second_flags_) flag.store(false, std::memory_order_relaxed);
+
+    if((settings_.predicates == INTEGER_PREDICATES) &&
+       !(is_integer_grid(first_objects_) && is_integer_grid(second_objects_))) {
+        throw std::invalid_argument("objects aren't on integer grid");
+    }
+
+    //pairs of flagged objects are needed in pairs mode
+    if(settings_.on_pair) settings_.flags_only = false;
+}
+
+void Bipartite_Finder::check_refs(Stored_Object_Ref first_ref, Stored_Object_Ref second_ref) {
+    const size_t first_num = stored_object_number(first_objects_, first_ref.type, first_ref.index);
+    const size_t second_num = stored_object_number(second_objects_, second_ref.type, second_ref.index);
+    if(is_pair_skipped(first_num, second_num)) {
+        if(settings_.stats != nullptr) settings_.stats->add_skipped_calls(1);
+        return;
+    }
+
+    const bool is_intersects = visit_stored_object(first_objects_, first_ref.type, first_ref.index,
+            [this, second_ref](const auto& obj1) {
+        return visit_stored_object(second_objects_, second_ref.type, second_ref.index,
+                [this, &obj1](const auto& obj2) {
+            return check_pair(obj1, obj2, settings_.predicates, settings_.stats);
+        });
+    });
+    if(is_intersects == false) return;
+
+    first_flags_[first_num].store(true, std::memory_order_relaxed);
+    second_flags_[second_num].store(true, std::memory_order_relaxed);
+    if(settings_.on_pair) settings_.on_pair(first_num, second_num);
+}
+
+Bipartite_Intersections Bipartite_Finder::compute_intersections() {
+    const auto search_start = std::chrono::steady_clock::now();
+    std::unique_ptr<Work_Stealing_Pool> pool;
+    if(settings_.threads_num != 1) {
+        pool = std::make_unique<Work_Stealing_Pool>(settings_.threads_num);
+    }
+
+    const std::vector<Stored_Object_Ref> first_refs = stored_objects_refs(first_objects_);
+    const std::vector<Stored_Object_Ref> second_refs = stored_objects_refs(second_objects_);
+    BVH_Tree first_tree(objects_boxes(first_objects_, first_refs));
+    BVH_Tree second_tree(objects_boxes(second_objects_, second_refs));
+
+    //only pairs with one object from every set are given by traversal
+    first_tree.for_each_overlapping_pair(second_tree, [this, &first_refs, &second_refs](size_t i, size_t j) {
+        check_refs(first_refs[i], second_refs[j]);
+    }, pool.get(), settings_.sequential_cutoff);
+
+    if(settings_.stats != nullptr) {
+        std::chrono::duration<double> search_time = std::chrono::steady_clock::now() - search_start;
+        settings_.stats->add_search_time(search_time.count());
+    }
+
+    std::vector<bool> first_flags = load_flags(first_flags_);
+    std::vector<bool> second_flags = load_flags(second_flags_);
+    return Bipartite_Intersections{
+        Objects_and_Intersections(std::move(first_objects_), std::move(first_flags)),
+        Objects_and_Intersections(std::move(second_objects_), std::move(second_flags))};
+}
+
+} //namespace geometry
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+#include "narrow_phase.h"
+
+namespace geometry {
+
+//-----------------------------------Bipartite_Finder------------------------------
+
+//flags of every set are in order of object numbers of this set
+struct Bipartite_Intersections {
+    Objects_and_Intersections first;
+    Objects_and_Intersections second;
+};
+
+//Intersections between objects of two sets (e.g. part and its fixture).
+//Every set has its own BVH and both trees are descended together,
+//so pairs of objects from one set are never even considered.
+//Settings used: threads_num, sequential_cutoff, predicates, flags_only, on_pair and stats,
+//on_pair gets number in first set and number in second set.
+class Bipartite_Finder final {
+private:
+    Geometry_Object_Storage first_objects_;
+    Geometry_Object_Storage second_objects_;
+    Finder_Settings settings_;
+    std::vector<std::atomic<bool>> first_flags_;
+    std::vector<std::atomic<bool>> second_flags_;
+
+    bool is_pair_skipped(size_t first_num, size_t second_num) const {
+        return settings_.flags_only &&
+               first_flags_[first_num].load(std::memory_order_relaxed) &&
+               second_flags_[second_num].load(std::memory_order_relaxed);
+    }
+    void check_refs(Stored_Object_Ref first_ref, Stored_Object_Ref second_ref);
+public:
+    Bipartite_Finder(Geometry_Object_Storage first_objects,
+                     Geometry_Object_Storage second_objects,
+                     Finder_Settings settings = Finder_Settings());
+
+    Bipartite_Intersections compute_intersections();
+};
+
+} //namespace geometry
@@ -0,0 +1,294 @@
+#include <cstdlib>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "bvh.h"
+
+namespace geometry {
+
+BVH_Tree::BVH_Tree(std::vector<Bounding_Box> boxes):
+    boxes_(std::move(boxes)),
+    indexes_(boxes_.size())
+{
+    for(size_t i = 0; i < indexes_.size(); ++i) {
+        indexes_[i] = i;
+    }
+
+    if(boxes_.empty()) return;
+
+    nodes_.reserve(2 * boxes_.size() / MAX_LEAF_SIZE + 1);
+    Node root;
+    root.begin = 0;
+    root.end = boxes_.size();
+    nodes_.push_back(root);
+    build(0);
+}
+
+void BVH_Tree::build(size_t node_num) {
+    Bounding_Box centers_box;
+    {
+        Node& node = nodes_[node_num];
+        for(size_t i = node.begin; i < node.end; ++i) {
+            const Bounding_Box& box = boxes_[indexes_[i]];
+            node.box.extend(box);
+            centers_box.extend(point(box.center(0), box.center(1), box.center(2)));
+        }
+        if(node.size() <= MAX_LEAF_SIZE) return;
+    }
+
+    size_t mid = split_binned_sah(node_num, centers_box);
+    const size_t begin = nodes_[node_num].begin;
+    const size_t end = nodes_[node_num].end;
+    if((mid == begin) || (mid == end)) return; //leaf is cheaper than any split
+
+    Node left, right;
+    left.begin = begin;
+    left.end = mid;
+    right.begin = mid;
+    right.end = end;
+
+    const size_t left_num = nodes_.size();
+    nodes_[node_num].left = left_num;
+    nodes_.push_back(left);
+    nodes_.push_back(right);
+
+    build(left_num);
+    build(left_num + 1);
+}
+
+size_t BVH_Tree::split_binned_sah(size_t node_num, const Bounding_Box& centers_box) {
+    const Node& node = nodes_[node_num];
+    const int axis = centers_box.largest_axis();
+    const double axis_low = centers_box.low(axis);
+    const double axis_extent = centers_box.extent(axis);
+
+    //all centers match: no plane can separate them, but halves by index
+    //keep leaves small, so duplicated objects don't make one huge leaf
+    if(axis_extent <= 0) return node.begin + node.size() / 2;
+
+    auto bin_of = [&](size_t obj_num) {
+        double k = (boxes_[obj_num].center(axis) - axis_low) / axis_extent;
+        size_t bin = static_cast<size_t>(k * BINS_NUM);
+        return std::min(bin, BINS_NUM - 1);
+    };
+
+    Bounding_Box bin_boxes[BINS_NUM];
+    size_t bin_counts[BINS_NUM] = {};
+    for(size_t i = node.begin; i < node.end; ++i) {
+        size_t bin = bin_of(indexes_[i]);
+        bin_boxes[bin].extend(boxes_[indexes_[i]]);
+        ++bin_counts[bin];
+    }
+
+    //sweep from the right to know cost of every right part
+    double right_areas[BINS_NUM];
+    size_t right_counts[BINS_NUM];
+    Bounding_Box acc_box;
+    size_t acc_count = 0;
+    for(size_t i = BINS_NUM - 1; i > 0; --i) {
+        acc_box.extend(bin_boxes[i]);
+        acc_count += bin_counts[i];
+        right_areas[i] = acc_box.surface_area();
+        right_counts[i] = acc_count;
+    }
+
+    //split after bin i: left part is [0, i], right part is [i + 1, BINS_NUM)
+    double best_cost = INFINITY;
+    size_t best_split = 0;
+    acc_box = Bounding_Box();
+    acc_count = 0;
+    for(size_t i = 0; i + 1 < BINS_NUM; ++i) {
+        acc_box.extend(bin_boxes[i]);
+        acc_count += bin_counts[i];
+        if((acc_count == 0) || (right_counts[i + 1] == 0)) continue;
+
+        double cost = acc_box.surface_area() * acc_count +
+                      right_areas[i + 1] * right_counts[i + 1];
+        if(cost < best_cost) {
+            best_cost = cost;
+            best_split = i;
+        }
+    }
+
+    const double leaf_cost = node.box.surface_area() * node.size();
+    if((best_cost >= leaf_cost) && (node.size() <= 2 * MAX_LEAF_SIZE)) return node.begin;
+
+    if(best_cost == INFINITY) {
+        //every center in one bin: median split keeps tree depth logarithmic
+        size_t mid = node.begin + node.size() / 2;
+        std::nth_element(indexes_.begin() + node.begin, indexes_.begin() + mid,
+                         indexes_.begin() + node.end, [&](size_t i1, size_t i2) {
+            return boxes_[i1].center(axis) < boxes_[i2].center(axis);
+        });
+        return mid;
+    }
+
+    auto it = std::partition(indexes_.begin() + node.begin, indexes_.begin() + node.end,
+                             [&](size_t obj_num) { return bin_of(obj_num) <= best_split; });
+    return static_cast<size_t>(it - indexes_.begin());
+}
+
+void BVH_Tree::for_each_overlapping_pair(const Pair_Callback& func,
+                                         Work_Stealing_Pool* pool,
+                                         size_t sequential_cutoff) const {
+    if(nodes_.empty()) return;
+    collide_self(0, func, pool, sequential_cutoff);
+}
+
+void BVH_Tree::for_each_overlapping_pair(const BVH_Tree& other, const Pair_Callback& func,
+                                         Work_Stealing_Pool* pool,
+                                         size_t sequential_cutoff) const {
+    if(nodes_.empty() || other.nodes_.empty()) return;
+    collide_trees(0, other, 0, func, pool, sequential_cutoff);
+}
+
+void BVH_Tree::for_each_overlapping_object(const Bounding_Box& box,
+                                           const Object_Callback& func) const {
+    if(nodes_.empty()) return;
+
+    //nodes which remain to be visited, depth of tree is small for any real input
+    std::vector<size_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while(!stack.empty()) {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+        if(is_boxes_intersects(node.box, box) == false) continue;
+
+        if(node.is_leaf()) {
+            for(size_t i = node.begin; i < node.end; ++i) {
+                if(is_boxes_intersects(boxes_[indexes_[i]], box) && !func(indexes_[i])) return;
+            }
+            continue;
+        }
+        stack.push_back(node.left + 1);
+        stack.push_back(node.left);
+    }
+}
+
+void BVH_Tree::collide_leaves(const Node& n1, const Node& n2, const Pair_Callback& func) const {
+    for(size_t i = n1.begin; i < n1.end; ++i) {
+        const Bounding_Box& box = boxes_[indexes_[i]];
+        for(size_t j = n2.begin; j < n2.end; ++j) {
+            if(is_boxes_intersects(box, boxes_[indexes_[j]])) {
+                func(indexes_[i], indexes_[j]);
+            }
+        }
+    }
+}
+
+void BVH_Tree::collide_self(size_t node_num, const Pair_Callback& func,
+                            Work_Stealing_Pool* pool, size_t sequential_cutoff) const {
+    const Node& node = nodes_[node_num];
+
+    if(node.is_leaf()) {
+        for(size_t i = node.begin; i < node.end; ++i) {
+            const Bounding_Box& box = boxes_[indexes_[i]];
+            for(size_t j = i + 1; j < node.end; ++j) {
+                if(is_boxes_intersects(box, boxes_[indexes_[j]])) {
+                    func(indexes_[i], indexes_[j]);
+                }
+            }
+        }
+        return;
+    }
+
+    const size_t left = node.left;
+    const size_t right = node.left + 1;
+
+    if((pool != nullptr) && (node.size() >= sequential_cutoff)) {
+        Task_Group group;
+        pool->submit(group, [this, left, &func, pool, sequential_cutoff]() {
+            collide_self(left, func, pool, sequential_cutoff);
+        });
+        pool->submit(group, [this, left, right, &func, pool, sequential_cutoff]() {
+            collide_pair(left, right, func, pool, sequential_cutoff);
+        });
+        collide_self(right, func, pool, sequential_cutoff);
+        pool->wait(group);
+        return;
+    }
+
+    collide_self(left, func, pool, sequential_cutoff);
+    collide_self(right, func, pool, sequential_cutoff);
+    collide_pair(left, right, func, pool, sequential_cutoff);
+}
+
+void BVH_Tree::collide_pair(size_t node1_num, size_t node2_num, const Pair_Callback& func,
+                            Work_Stealing_Pool* pool, size_t sequential_cutoff) const {
+    const Node& n1 = nodes_[node1_num];
+    const Node& n2 = nodes_[node2_num];
+
+    if(is_boxes_intersects(n1.box, n2.box) == false) return;
+
+    if(n1.is_leaf() && n2.is_leaf()) {
+        collide_leaves(n1, n2, func);
+        return;
+    }
+
+    //descending into the bigger node keeps both sides balanced
+    size_t split_num = node1_num, other_num = node2_num;
+    if(n1.is_leaf() || ((n2.is_leaf() == false) && (n2.size() > n1.size()))) {
+        split_num = node2_num;
+        other_num = node1_num;
+    }
+    const size_t left = nodes_[split_num].left;
+
+    if((pool != nullptr) && (n1.size() + n2.size() >= sequential_cutoff)) {
+        Task_Group group;
+        pool->submit(group, [this, left, other_num, &func, pool, sequential_cutoff]() {
+            collide_pair(left, other_num, func, pool, sequential_cutoff);
+        });
+        collide_pair(left + 1, other_num, func, pool, sequential_cutoff);
+        pool->wait(group);
+        return;
+    }
+
+    collide_pair(left, other_num, func, pool, sequential_cutoff);
+    collide_pair(left + 1, other_num, func, pool, sequential_cutoff);
+}
+
+void BVH_Tree::collide_trees(size_t node_num, const BVH_Tree& other, size_t other_num,
+                             const Pair_Callback& func,
+                             Work_Stealing_Pool* pool, size_t sequential_cutoff) const {
+    const Node& n1 = nodes_[node_num];
+    const Node& n2 = other.nodes_[other_num];
+
+    if(is_boxes_intersects(n1.box, n2.box) == false) return;
+
+    if(n1.is_leaf() && n2.is_leaf()) {
+        for(size_t i = n1.begin; i < n1.end; ++i) {
+            const Bounding_Box& box = boxes_[indexes_[i]];
+            for(size_t j = n2.begin; j < n2.end; ++j) {
+                if(is_boxes_intersects(box, other.boxes_[other.indexes_[j]])) {
+                    func(indexes_[i], other.indexes_[j]);
+                }
+            }
+        }
+        return;
+    }
+
+    //descending into the bigger node keeps both sides balanced
+    const bool is_split_this = (n2.is_leaf() || ((n1.is_leaf() == false) && (n1.size() >= n2.size())));
+    const size_t left = is_split_this ? n1.left : n2.left;
+    auto collide_child = [this, &other, node_num, other_num, is_split_this, &func, pool, sequential_cutoff]
+                         (size_t child) {
+        if(is_split_this) collide_trees(child, other, other_num, func, pool, sequential_cutoff);
+        else collide_trees(node_num, other, child, func, pool, sequential_cutoff);
+    };
+
+    if((pool != nullptr) && (n1.size() + n2.size() >= sequential_cutoff)) {
+        Task_Group group;
+        pool->submit(group, [&collide_child, left]() { collide_child(left); });
+        collide_child(left + 1);
+        pool->wait(group);
+        return;
+    }
+
+    collide_child(left);
+    collide_child(left + 1);
+}
+
+} //namespace geometry
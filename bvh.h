@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "geometry.h"
+#include "thread_pool.h"
+
+namespace geometry {
+
+//------------------------------------------BVH_Tree-------------------------------
+
+//Bounding volume hierarchy over boxes of objects, built with binned SAH.
+//Object numbers in callbacks are indexes in the boxes array given to constructor.
+class BVH_Tree final {
+public:
+    using Pair_Callback = std::function<void(size_t, size_t)>;
+    //returns false to stop the search
+    using Object_Callback = std::function<bool(size_t)>;
+private:
+    static const size_t MAX_LEAF_SIZE = 4;
+    static const size_t BINS_NUM = 16;
+
+    struct Node {
+        Bounding_Box box;
+        size_t begin;     //objects of node are indexes_[begin, end)
+        size_t end;
+        size_t left = 0;  //right child is left + 1, 0 for leaf (root can't be a child)
+
+        bool is_leaf() const { return left == 0; }
+        size_t size() const { return end - begin; }
+    };
+
+    std::vector<Bounding_Box> boxes_;
+    std::vector<size_t> indexes_;
+    std::vector<Node> nodes_;
+
+    void build(size_t node_num);
+    size_t split_binned_sah(size_t node_num, const Bounding_Box& centers_box);
+
+    void collide_leaves(const Node& n1, const Node& n2, const Pair_Callback& func) const;
+    void collide_self(size_t node_num, const Pair_Callback& func,
+                      Work_Stealing_Pool* pool, size_t sequential_cutoff) const;
+    void collide_pair(size_t node1_num, size_t node2_num, const Pair_Callback& func,
+                      Work_Stealing_Pool* pool, size_t sequential_cutoff) const;
+    void collide_trees(size_t node_num, const BVH_Tree& other, size_t other_num,
+                       const Pair_Callback& func,
+                       Work_Stealing_Pool* pool, size_t sequential_cutoff) const;
+public:
+    BVH_Tree(std::vector<Bounding_Box> boxes);
+
+    size_t objects_num() const { return boxes_.size(); }
+    size_t nodes_num() const { return nodes_.size(); }
+    const Bounding_Box& object_box(size_t num) const { return boxes_[num]; }
+
+    //calls func once for every unordered pair of objects with intersecting boxes,
+    //with pool func is called concurrently for subtrees bigger than sequential_cutoff
+    void for_each_overlapping_pair(const Pair_Callback& func,
+                                   Work_Stealing_Pool* pool = nullptr,
+                                   size_t sequential_cutoff = 0) const;
+    //calls func(i, j) once for every object i of this tree and object j of other tree
+    //with intersecting boxes, both trees are descended together
+    void for_each_overlapping_pair(const BVH_Tree& other, const Pair_Callback& func,
+                                   Work_Stealing_Pool* pool = nullptr,
+                                   size_t sequential_cutoff = 0) const;
+    //calls func for every object whose box intersects box, until func returns false;
+    //it doesn't change tree, so queries can run concurrently
+    void for_each_overlapping_object(const Bounding_Box& box, const Object_Callback& func) const;
+};
+
+} //namespace geometry
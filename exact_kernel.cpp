@@ -0,0 +1,230 @@
+#include <cassert>
+#include <algorithm>
+
+#include "exact_kernel.h"
+#include "exact_predicates.h"
+
+namespace geometry {
+
+//----------------------------------------Exact_Kernel-----------------------------
+
+namespace {
+
+//coordinates left when axis is dropped, in cyclic order
+template <typename Coord>
+int orient2d_projected(const Coord a[3], const Coord b[3], const Coord c[3], int axis) {
+    const int i = (axis + 1) % 3, j = (axis + 2) % 3;
+    const Coord a2[2] = {a[i], a[j]}, b2[2] = {b[i], b[j]}, c2[2] = {c[i], c[j]};
+    return orient2d(a2, b2, c2);
+}
+
+//axis which can be dropped without putting a, b, c on one line, -1 if they are on one line
+template <typename Coord>
+int projection_axis(const Coord a[3], const Coord b[3], const Coord c[3]) {
+    for(int axis = 0; axis < 3; ++axis) {
+        if(orient2d_projected(a, b, c, axis) != 0) return axis;
+    }
+    return -1;
+}
+
+//projection along this axis is one-to-one on the triangle plane
+template <typename Coord>
+int triangle_axis(const Coord t[3][3]) {
+    const int axis = projection_axis(t[0], t[1], t[2]);
+    assert(axis >= 0);
+    return axis;
+}
+
+//p is on line ab already
+template <typename Coord>
+bool is_between(const Coord a[3], const Coord b[3], const Coord p[3]) {
+    for(int i = 0; i < 3; ++i) {
+        if((p[i] < std::min(a[i], b[i])) || (p[i] > std::max(a[i], b[i]))) return false;
+    }
+    return true;
+}
+
+bool is_one_side(const int sides[3]) {
+    return ((sides[0] > 0) && (sides[1] > 0) && (sides[2] > 0)) ||
+           ((sides[0] < 0) && (sides[1] < 0) && (sides[2] < 0));
+}
+
+//there are no sides of different signs, zeros are on borders
+bool is_consistent(int s0, int s1, int s2) {
+    const bool has_negative = (s0 < 0) || (s1 < 0) || (s2 < 0);
+    const bool has_positive = (s0 > 0) || (s1 > 0) || (s2 > 0);
+    return !(has_negative && has_positive);
+}
+
+//all objects below are on the triangle plane, projection keeps this plane
+
+template <typename Coord>
+bool is_point_in_triangle_2d(const Coord t[3][3], const Coord p[3], int axis) {
+    return is_consistent(orient2d_projected(t[0], t[1], p, axis),
+                         orient2d_projected(t[1], t[2], p, axis),
+                         orient2d_projected(t[2], t[0], p, axis));
+}
+
+template <typename Coord>
+bool is_cuts_intersects_2d(const Coord a[3], const Coord b[3],
+                           const Coord c[3], const Coord d[3], int axis) {
+    const int o1 = orient2d_projected(a, b, c, axis);
+    const int o2 = orient2d_projected(a, b, d, axis);
+    const int o3 = orient2d_projected(c, d, a, axis);
+    const int o4 = orient2d_projected(c, d, b, axis);
+    if((o1 * o2 < 0) && (o3 * o4 < 0)) return true;
+
+    //otherwise they can only touch: end of one cut lies on the other one
+    return ((o1 == 0) && is_between(a, b, c)) || ((o2 == 0) && is_between(a, b, d)) ||
+           ((o3 == 0) && is_between(c, d, a)) || ((o4 == 0) && is_between(c, d, b));
+}
+
+template <typename Coord>
+bool is_triangle_and_cut_intersects_2d(const Coord t[3][3], const Coord begin[3],
+                                       const Coord end[3], int axis) {
+    if(is_point_in_triangle_2d(t, begin, axis)) return true;
+    for(int i = 0; i < 3; ++i) {
+        if(is_cuts_intersects_2d(t[i], t[(i + 1) % 3], begin, end, axis)) return true;
+    }
+    return false;
+}
+
+template <typename Coord>
+bool is_triangles_intersects_2d(const Coord t1[3][3], const Coord t2[3][3], int axis) {
+    for(int i = 0; i < 3; ++i) {
+        for(int j = 0; j < 3; ++j) {
+            if(is_cuts_intersects_2d(t1[i], t1[(i + 1) % 3], t2[j], t2[(j + 1) % 3], axis)) return true;
+        }
+    }
+    //without crossing sides one triangle can only be inside the other one
+    return is_point_in_triangle_2d(t1, t2[0], axis) || is_point_in_triangle_2d(t2, t1[0], axis);
+}
+
+} //namespace
+
+template <typename Coord>
+bool is_triangles_intersects_exact(const Coord t1[3][3], const Coord t2[3][3]) noexcept {
+    int sides2[3];
+    for(int i = 0; i < 3; ++i) sides2[i] = orient3d(t1[0], t1[1], t1[2], t2[i]);
+    if(is_one_side(sides2)) return false;
+    if((sides2[0] == 0) && (sides2[1] == 0) && (sides2[2] == 0)) {
+        return is_triangles_intersects_2d(t1, t2, triangle_axis(t1));
+    }
+
+    int sides1[3];
+    for(int i = 0; i < 3; ++i) sides1[i] = orient3d(t2[0], t2[1], t2[2], t1[i]);
+    if(is_one_side(sides1)) return false;
+
+    //common part of triangles lies on the line of their planes,
+    //its ends are on sides of triangles
+    for(int i = 0; i < 3; ++i) {
+        if(is_triangle_and_cut_intersects_exact(t1, t2[i], t2[(i + 1) % 3])) return true;
+        if(is_triangle_and_cut_intersects_exact(t2, t1[i], t1[(i + 1) % 3])) return true;
+    }
+    return false;
+}
+
+template <typename Coord>
+bool is_triangle_and_cut_intersects_exact(const Coord t[3][3],
+                                          const Coord begin[3], const Coord end[3]) noexcept {
+    const int side_begin = orient3d(t[0], t[1], t[2], begin);
+    const int side_end = orient3d(t[0], t[1], t[2], end);
+    if(side_begin * side_end > 0) return false;
+
+    if((side_begin == 0) && (side_end == 0)) {
+        return is_triangle_and_cut_intersects_2d(t, begin, end, triangle_axis(t));
+    }
+    if(side_begin == 0) return is_point_in_triangle_2d(t, begin, triangle_axis(t));
+    if(side_end == 0) return is_point_in_triangle_2d(t, end, triangle_axis(t));
+
+    //cut crosses the plane: crossing point is inside if cut passes all sides the same way
+    return is_consistent(orient3d(begin, end, t[0], t[1]),
+                         orient3d(begin, end, t[1], t[2]),
+                         orient3d(begin, end, t[2], t[0]));
+}
+
+template <typename Coord>
+bool is_triangle_and_point_intersects_exact(const Coord t[3][3], const Coord p[3]) noexcept {
+    if(orient3d(t[0], t[1], t[2], p) != 0) return false;
+    return is_point_in_triangle_2d(t, p, triangle_axis(t));
+}
+
+template <typename Coord>
+bool is_cuts_intersects_exact(const Coord begin1[3], const Coord end1[3],
+                              const Coord begin2[3], const Coord end2[3]) noexcept {
+    if(orient3d(begin1, end1, begin2, end2) != 0) return false;
+
+    int axis = projection_axis(begin1, end1, begin2);
+    if(axis < 0) axis = projection_axis(begin1, end1, end2);
+    if(axis >= 0) return is_cuts_intersects_2d(begin1, end1, begin2, end2, axis);
+
+    //all ends are on one line
+    return is_between(begin1, end1, begin2) || is_between(begin1, end1, end2) ||
+           is_between(begin2, end2, begin1);
+}
+
+template <typename Coord>
+bool is_cut_and_point_intersects_exact(const Coord begin[3], const Coord end[3],
+                                       const Coord p[3]) noexcept {
+    for(int axis = 0; axis < 3; ++axis) {
+        if(orient2d_projected(begin, end, p, axis) != 0) return false;
+    }
+    return is_between(begin, end, p);
+}
+
+template <typename Coord>
+bool is_points_match_exact(const Coord p1[3], const Coord p2[3]) noexcept {
+    return (p1[0] == p2[0]) && (p1[1] == p2[1]) && (p1[2] == p2[2]);
+}
+
+template <typename Coord>
+int point_side_exact(const Coord pl[3][3], const Coord p[3]) noexcept {
+    //orient3d is positive on the side opposite to normal
+    return -orient3d(pl[0], pl[1], pl[2], p);
+}
+
+template <typename Coord>
+int cut_side_exact(const Coord pl[3][3], const Coord begin[3], const Coord end[3]) noexcept {
+    const int side = point_side_exact(pl, begin);
+    if(side == 0) return 0;
+    return (point_side_exact(pl, end) == side) ? side : 0;
+}
+
+template <typename Coord>
+int triangle_side_exact(const Coord pl[3][3], const Coord t[3][3]) noexcept {
+    const int side = point_side_exact(pl, t[0]);
+    if(side == 0) return 0;
+    if(point_side_exact(pl, t[1]) != side) return 0;
+    return (point_side_exact(pl, t[2]) == side) ? side : 0;
+}
+
+//coordinates of storages
+template bool is_triangles_intersects_exact(const double[3][3], const double[3][3]) noexcept;
+template bool is_triangle_and_cut_intersects_exact(const double[3][3], const double[3],
+                                                   const double[3]) noexcept;
+template bool is_triangle_and_point_intersects_exact(const double[3][3], const double[3]) noexcept;
+template bool is_cuts_intersects_exact(const double[3], const double[3], const double[3],
+                                       const double[3]) noexcept;
+template bool is_cut_and_point_intersects_exact(const double[3], const double[3],
+                                                const double[3]) noexcept;
+template bool is_points_match_exact(const double[3], const double[3]) noexcept;
+template int point_side_exact(const double[3][3], const double[3]) noexcept;
+template int cut_side_exact(const double[3][3], const double[3], const double[3]) noexcept;
+template int triangle_side_exact(const double[3][3], const double[3][3]) noexcept;
+
+//integer grid of fixed decimal inputs (see fixed_decimal.h)
+template bool is_triangles_intersects_exact(const int32_t[3][3], const int32_t[3][3]) noexcept;
+template bool is_triangle_and_cut_intersects_exact(const int32_t[3][3], const int32_t[3],
+                                                   const int32_t[3]) noexcept;
+template bool is_triangle_and_point_intersects_exact(const int32_t[3][3],
+                                                     const int32_t[3]) noexcept;
+template bool is_cuts_intersects_exact(const int32_t[3], const int32_t[3], const int32_t[3],
+                                       const int32_t[3]) noexcept;
+template bool is_cut_and_point_intersects_exact(const int32_t[3], const int32_t[3],
+                                                const int32_t[3]) noexcept;
+template bool is_points_match_exact(const int32_t[3], const int32_t[3]) noexcept;
+template int point_side_exact(const int32_t[3][3], const int32_t[3]) noexcept;
+template int cut_side_exact(const int32_t[3][3], const int32_t[3], const int32_t[3]) noexcept;
+template int triangle_side_exact(const int32_t[3][3], const int32_t[3][3]) noexcept;
+
+} //namespace geometry
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+namespace geometry {
+
+//----------------------------------------Exact_Kernel-----------------------------
+
+//Checks of objects by exact predicates: objects intersect only if they have
+//a common point, there is no tolerance and results don't depend on coordinates scale.
+//Objects are given by their points as in tri_tri_kernel.h,
+//triangles must not be degenerate and cuts must have different ends.
+//Coord is double or int32_t: integer coordinates must not be bigger than
+//MAX_INTEGER_COORD by absolute value, their signs need no filters (see exact_predicates.h).
+
+template <typename Coord>
+bool is_triangles_intersects_exact(const Coord t1[3][3], const Coord t2[3][3]) noexcept;
+template <typename Coord>
+bool is_triangle_and_cut_intersects_exact(const Coord t[3][3],
+                                          const Coord begin[3], const Coord end[3]) noexcept;
+template <typename Coord>
+bool is_triangle_and_point_intersects_exact(const Coord t[3][3], const Coord p[3]) noexcept;
+template <typename Coord>
+bool is_cuts_intersects_exact(const Coord begin1[3], const Coord end1[3],
+                              const Coord begin2[3], const Coord end2[3]) noexcept;
+template <typename Coord>
+bool is_cut_and_point_intersects_exact(const Coord begin[3], const Coord end[3],
+                                       const Coord p[3]) noexcept;
+template <typename Coord>
+bool is_points_match_exact(const Coord p1[3], const Coord p2[3]) noexcept;
+
+//Sides of objects for plane through three points pl[0], pl[1], pl[2]:
+//1 is the side of normal (pl[1] - pl[0]) x (pl[2] - pl[0]), -1 is the other one,
+//0 if object touches or crosses the plane
+template <typename Coord>
+int point_side_exact(const Coord pl[3][3], const Coord p[3]) noexcept;
+template <typename Coord>
+int cut_side_exact(const Coord pl[3][3], const Coord begin[3], const Coord end[3]) noexcept;
+template <typename Coord>
+int triangle_side_exact(const Coord pl[3][3], const Coord t[3][3]) noexcept;
+
+} //namespace geometry
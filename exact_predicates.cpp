@@ -0,0 +1,266 @@
+#include <cmath>
+
+#include "exact_predicates.h"
+
+namespace geometry {
+
+//-------------------------------------Exact_Predicates----------------------------
+
+namespace {
+
+//half of distance between 1 and the next double, so a + b has error at most EPSILON * |a + b|
+const double EPSILON = 1.0 / 9007199254740992.0;  //2^-53
+const double SPLITTER = 134217729.0;              //2^27 + 1
+
+//error bounds of determinants computed in doubles, relative to sums of absolute products
+const double ORIENT2D_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+const double ORIENT3D_BOUND = (7.0 + 56.0 * EPSILON) * EPSILON;
+
+//a + b = x + y exactly, x is the rounded sum
+void two_sum(double a, double b, double& x, double& y) {
+    x = a + b;
+    const double b_virtual = x - a;
+    const double a_virtual = x - b_virtual;
+    y = (a - a_virtual) + (b - b_virtual);
+}
+
+//a - b = x + y exactly
+void two_diff(double a, double b, double& x, double& y) {
+    x = a - b;
+    const double b_virtual = a - x;
+    const double a_virtual = x + b_virtual;
+    y = (a - a_virtual) + (b_virtual - b);
+}
+
+//|a| >= |b|, a + b = x + y exactly
+void fast_two_sum(double a, double b, double& x, double& y) {
+    x = a + b;
+    y = b - (x - a);
+}
+
+//a = hi + lo, both halves have 26 significant bits at most
+void split(double a, double& hi, double& lo) {
+    const double c = SPLITTER * a;
+    hi = c - (c - a);
+    lo = a - hi;
+}
+
+//a * b = x + y exactly (Dekker), b is split already
+void two_product(double a, double b, double b_hi, double b_lo, double& x, double& y) {
+    x = a * b;
+    double a_hi, a_lo;
+    split(a, a_hi, a_lo);
+    const double err1 = x - a_hi * b_hi;
+    const double err2 = err1 - a_lo * b_hi;
+    const double err3 = err2 - a_hi * b_lo;
+    y = a_lo * b_lo - err3;
+}
+
+//Exact value as a sum of doubles: components don't overlap and they go
+//in order of increasing magnitude, so the last one gives the sign.
+//Zero components are never kept, empty expansion is zero.
+struct Expansion {
+    static const int CAPACITY = 192; //enough for orient3d of differences
+    double c[CAPACITY];
+    int size = 0;
+
+    void push(double value) {
+        if(value != 0.0) c[size++] = value;
+    }
+    int sign() const {
+        if(size == 0) return 0;
+        return (c[size - 1] > 0.0) ? 1 : -1;
+    }
+};
+
+Expansion difference(double a, double b) {
+    double x, y;
+    two_diff(a, b, x, y);
+    Expansion h;
+    h.push(y);
+    h.push(x);
+    return h;
+}
+
+//e + b, one pass of two_sum through components
+Expansion grow(const Expansion& e, double b) {
+    Expansion h;
+    double q = b;
+    for(int i = 0; i < e.size; ++i) {
+        double q_new, tail;
+        two_sum(q, e.c[i], q_new, tail);
+        h.push(tail);
+        q = q_new;
+    }
+    h.push(q);
+    return h;
+}
+
+Expansion sum(const Expansion& e, const Expansion& f) {
+    Expansion h = e;
+    for(int i = 0; i < f.size; ++i) {
+        h = grow(h, f.c[i]);
+    }
+    return h;
+}
+
+Expansion negate(Expansion e) {
+    for(int i = 0; i < e.size; ++i) e.c[i] = -e.c[i];
+    return e;
+}
+
+Expansion scale(const Expansion& e, double b) {
+    Expansion h;
+    if(e.size == 0) return h;
+
+    double b_hi, b_lo;
+    split(b, b_hi, b_lo);
+    double q, tail;
+    two_product(e.c[0], b, b_hi, b_lo, q, tail);
+    h.push(tail);
+    for(int i = 1; i < e.size; ++i) {
+        double product1, product0, sum_value;
+        two_product(e.c[i], b, b_hi, b_lo, product1, product0);
+        two_sum(q, product0, sum_value, tail);
+        h.push(tail);
+        fast_two_sum(product1, sum_value, q, tail);
+        h.push(tail);
+    }
+    h.push(q);
+    return h;
+}
+
+Expansion product(const Expansion& e, const Expansion& f) {
+    Expansion h;
+    for(int i = 0; i < f.size; ++i) {
+        h = sum(h, scale(e, f.c[i]));
+    }
+    return h;
+}
+
+int orient2d_exact(const double a[2], const double b[2], const double c[2]) {
+    const Expansion acx = difference(a[0], c[0]), acy = difference(a[1], c[1]);
+    const Expansion bcx = difference(b[0], c[0]), bcy = difference(b[1], c[1]);
+    return sum(product(acx, bcy), negate(product(acy, bcx))).sign();
+}
+
+int orient3d_exact(const double a[3], const double b[3], const double c[3], const double d[3]) {
+    Expansion ad[3], bd[3], cd[3];
+    for(int i = 0; i < 3; ++i) {
+        ad[i] = difference(a[i], d[i]);
+        bd[i] = difference(b[i], d[i]);
+        cd[i] = difference(c[i], d[i]);
+    }
+
+    //expansion by the first column
+    const Expansion minor_a = sum(product(bd[1], cd[2]), negate(product(bd[2], cd[1])));
+    const Expansion minor_b = sum(product(cd[1], ad[2]), negate(product(cd[2], ad[1])));
+    const Expansion minor_c = sum(product(ad[1], bd[2]), negate(product(ad[2], bd[1])));
+    const Expansion det = sum(sum(product(ad[0], minor_a), product(bd[0], minor_b)),
+                              product(cd[0], minor_c));
+    return det.sign();
+}
+
+template <typename T>
+int sign(T value) {
+    if(value > 0) return 1;
+    if(value < 0) return -1;
+    return 0;
+}
+
+#ifdef __SIZEOF_INT128__
+using int128 = __int128;
+#endif
+
+//sign of determinant computed in doubles when its error bound is smaller,
+//differences of integer coordinates are exact, so the same bound holds for them
+template <typename Coord>
+bool is_orient3d_filtered(const Coord a[3], const Coord b[3], const Coord c[3], const Coord d[3],
+                          int& det_sign) {
+    const double adx = a[0] - d[0], ady = a[1] - d[1], adz = a[2] - d[2];
+    const double bdx = b[0] - d[0], bdy = b[1] - d[1], bdz = b[2] - d[2];
+    const double cdx = c[0] - d[0], cdy = c[1] - d[1], cdz = c[2] - d[2];
+
+    const double bdx_cdy = bdx * cdy, cdx_bdy = cdx * bdy;
+    const double cdx_ady = cdx * ady, adx_cdy = adx * cdy;
+    const double adx_bdy = adx * bdy, bdx_ady = bdx * ady;
+
+    const double det = adz * (bdx_cdy - cdx_bdy) + bdz * (cdx_ady - adx_cdy) +
+                       cdz * (adx_bdy - bdx_ady);
+    const double permanent = (fabs(bdx_cdy) + fabs(cdx_bdy)) * fabs(adz) +
+                             (fabs(cdx_ady) + fabs(adx_cdy)) * fabs(bdz) +
+                             (fabs(adx_bdy) + fabs(bdx_ady)) * fabs(cdz);
+
+    if(fabs(det) > ORIENT3D_BOUND * permanent) {
+        det_sign = sign(det);
+        return true;
+    }
+    return false;
+}
+
+} //namespace
+
+int orient2d(const double a[2], const double b[2], const double c[2]) {
+    const double det_left = (a[0] - c[0]) * (b[1] - c[1]);
+    const double det_right = (a[1] - c[1]) * (b[0] - c[0]);
+    const double det = det_left - det_right;
+
+    //products of different signs can't cancel each other
+    double det_sum;
+    if(det_left > 0.0) {
+        if(det_right <= 0.0) return sign(det);
+        det_sum = det_left + det_right;
+    }
+    else if(det_left < 0.0) {
+        if(det_right >= 0.0) return sign(det);
+        det_sum = -det_left - det_right;
+    }
+    else {
+        return sign(det);
+    }
+
+    if(fabs(det) >= ORIENT2D_BOUND * det_sum) return sign(det);
+    return orient2d_exact(a, b, c);
+}
+
+int orient3d(const double a[3], const double b[3], const double c[3], const double d[3]) {
+    int det_sign;
+    if(is_orient3d_filtered(a, b, c, d, det_sign)) return det_sign;
+    return orient3d_exact(a, b, c, d);
+}
+
+int orient2d(const int32_t a[2], const int32_t b[2], const int32_t c[2]) {
+    const int64_t acx = int64_t(a[0]) - c[0], acy = int64_t(a[1]) - c[1];
+    const int64_t bcx = int64_t(b[0]) - c[0], bcy = int64_t(b[1]) - c[1];
+    return sign(acx * bcy - acy * bcx);
+}
+
+int orient3d(const int32_t a[3], const int32_t b[3], const int32_t c[3], const int32_t d[3]) {
+    //filter is cheaper than int128 products, they are needed for almost degenerate inputs
+    int det_sign;
+    if(is_orient3d_filtered(a, b, c, d, det_sign)) return det_sign;
+
+#ifdef __SIZEOF_INT128__
+    int64_t ad[3], bd[3], cd[3];
+    for(int i = 0; i < 3; ++i) {
+        ad[i] = int64_t(a[i]) - d[i];
+        bd[i] = int64_t(b[i]) - d[i];
+        cd[i] = int64_t(c[i]) - d[i];
+    }
+
+    //expansion by the last column as in double orient3d
+    const int128 det = int128(ad[2]) * (bd[0] * cd[1] - cd[0] * bd[1]) +
+                       int128(bd[2]) * (cd[0] * ad[1] - ad[0] * cd[1]) +
+                       int128(cd[2]) * (ad[0] * bd[1] - bd[0] * ad[1]);
+    return sign(det);
+#else
+    //integers are exact in doubles, so double predicate gives the same sign
+    const double a_coords[3] = {double(a[0]), double(a[1]), double(a[2])};
+    const double b_coords[3] = {double(b[0]), double(b[1]), double(b[2])};
+    const double c_coords[3] = {double(c[0]), double(c[1]), double(c[2])};
+    const double d_coords[3] = {double(d[0]), double(d[1]), double(d[2])};
+    return orient3d(a_coords, b_coords, c_coords, d_coords);
+#endif
+}
+
+} //namespace geometry
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+namespace geometry {
+
+//-------------------------------------Exact_Predicates----------------------------
+
+//Signs of orientation determinants which are always right for double inputs
+//(without overflow and underflow), there is no tolerance in them.
+//Determinant is computed in doubles first, its error is bounded by a constant
+//times sum of absolute values of its products, so the sign is known at once
+//when determinant is bigger than this bound. Only uncertain cases (inputs
+//which are almost degenerate) are computed again exactly by expansion arithmetic.
+
+//sign of det(a - c, b - c): 1 if a, b, c go counterclockwise, 0 if they are on one line
+int orient2d(const double a[2], const double b[2], const double c[2]);
+
+//sign of det(a - d, b - d, c - d): 1 if d is on the other side of plane abc
+//than its normal (b - a) x (c - a), 0 if four points are on one plane
+int orient3d(const double a[3], const double b[3], const double c[3], const double d[3]);
+
+//the same signs for integer coordinates not bigger than MAX_INTEGER_COORD by absolute value:
+//differences and 2x2 minors fit in int64, so uncertain determinants are computed
+//in int128 at once instead of expansions
+const int32_t MAX_INTEGER_COORD = (1 << 30) - 1;
+int orient2d(const int32_t a[2], const int32_t b[2], const int32_t c[2]);
+int orient3d(const int32_t a[3], const int32_t b[3], const int32_t c[3], const int32_t d[3]);
+
+} //namespace geometry
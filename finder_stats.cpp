@@ -0,0 +1,176 @@
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "finder_stats.h"
+
+namespace geometry {
+
+//--------------------------------------Finder_Stats-------------------------------
+
+namespace {
+
+const char* const KIND_NAMES[3] = {"triangle", "cut", "point"};
+
+size_t log2_bin(size_t value) {
+    size_t bin = 0;
+    while((value >>= 1) != 0) ++bin;
+    return bin;
+}
+
+//histogram without empty tail
+void write_histogram(std::ostream& out, const std::atomic<uint64_t>* bins, size_t size) {
+    size_t used = size;
+    while((used > 0) && (bins[used - 1].load(std::memory_order_relaxed) == 0)) --used;
+
+    out << "[";
+    for(size_t k = 0; k < used; ++k) {
+        out << (k > 0 ? ", " : "") << bins[k].load(std::memory_order_relaxed);
+    }
+    out << "]";
+}
+
+double rate(uint64_t part, uint64_t total) {
+    return (total == 0) ? 0.0 : static_cast<double>(part) / static_cast<double>(total);
+}
+
+} //namespace
+
+Finder_Stats::Finder_Stats():
+    search_ns_(0),
+    unsplit_subsets_(0),
+    unsplit_objects_(0),
+    skipped_calls_(0)
+{
+    for(auto& time : phases_ns_) time.store(0, std::memory_order_relaxed);
+    for(auto& bin : depths_) bin.store(0, std::memory_order_relaxed);
+    for(auto& bin : subset_sizes_) bin.store(0, std::memory_order_relaxed);
+    for(auto& row : narrow_calls_) {
+        for(auto& calls : row) calls.store(0, std::memory_order_relaxed);
+    }
+    for(auto& row : plane_tests_) {
+        for(auto& tests : row) tests.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t Finder_Stats::to_ns(double seconds) {
+    return static_cast<uint64_t>(std::llround(std::max(seconds, 0.0) * 1e9));
+}
+
+void Finder_Stats::add_phase_time(finder_phase phase, double seconds) {
+    phases_ns_[phase].fetch_add(to_ns(seconds), std::memory_order_relaxed);
+}
+
+void Finder_Stats::add_search_time(double seconds) {
+    search_ns_.fetch_add(to_ns(seconds), std::memory_order_relaxed);
+}
+
+void Finder_Stats::add_split(size_t depth, size_t subset_size) {
+    depths_[std::min(depth, HISTOGRAM_SIZE - 1)].fetch_add(1, std::memory_order_relaxed);
+    subset_sizes_[std::min(log2_bin(subset_size), HISTOGRAM_SIZE - 1)].fetch_add(
+                1, std::memory_order_relaxed);
+}
+
+void Finder_Stats::add_unsplit_subset(size_t subset_size) {
+    unsplit_subsets_.fetch_add(1, std::memory_order_relaxed);
+    unsplit_objects_.fetch_add(subset_size, std::memory_order_relaxed);
+}
+
+void Finder_Stats::add_narrow_calls(g_obj_type type1, g_obj_type type2, uint64_t calls_num) {
+    narrow_calls_[std::min(type1, type2)][std::max(type1, type2)].fetch_add(
+                calls_num, std::memory_order_relaxed);
+}
+
+void Finder_Stats::add_skipped_calls(uint64_t calls_num) {
+    skipped_calls_.fetch_add(calls_num, std::memory_order_relaxed);
+}
+
+void Finder_Stats::add_plane_test(g_obj_type other_type, plane_test_result result) {
+    plane_tests_[other_type][result].fetch_add(1, std::memory_order_relaxed);
+}
+
+double Finder_Stats::phase_time(finder_phase phase) const {
+    return phases_ns_[phase].load(std::memory_order_relaxed) / 1e9;
+}
+
+double Finder_Stats::search_time() const {
+    return search_ns_.load(std::memory_order_relaxed) / 1e9;
+}
+
+uint64_t Finder_Stats::narrow_calls(g_obj_type type1, g_obj_type type2) const {
+    return narrow_calls_[std::min(type1, type2)][std::max(type1, type2)].load(
+                std::memory_order_relaxed);
+}
+
+uint64_t Finder_Stats::peak_memory() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == 0) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);        //bytes
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; //kilobytes
+#endif
+#endif
+}
+
+void Finder_Stats::write_json(std::ostream& out) const {
+    const double narrow_time = phase_time(NARROW_PHASE);
+    out << "{\n";
+    out << "  \"phases_seconds\": {\"parse\": " << phase_time(PARSE_PHASE)
+        << ", \"storage\": " << phase_time(STORAGE_PHASE)
+        << ", \"broad_phase\": " << std::max(search_time() - narrow_time, 0.0)
+        << ", \"narrow_phase\": " << narrow_time << "},\n";
+    out << "  \"search_seconds\": " << search_time() << ",\n";
+
+    out << "  \"recursion_depths\": ";
+    write_histogram(out, depths_, HISTOGRAM_SIZE);
+    out << ",\n  \"subset_sizes_log2\": ";
+    write_histogram(out, subset_sizes_, HISTOGRAM_SIZE);
+    out << ",\n  \"unsplit_subsets\": {\"subsets\": "
+        << unsplit_subsets_.load(std::memory_order_relaxed) << ", \"objects\": " << unsplit_objects_.load(std::memory_order_relaxed) << "}";
+
+    out << ",\n  \"narrow_phase_calls\": {";
+    bool is_first = true;
+    for(int i = 0; i < 3; ++i) {
+        for(int j = i; j < 3; ++j) {
+            out << (is_first ? "" : ", ") << "\"" << KIND_NAMES[i] << "_" << KIND_NAMES[j] << "\": "
+                << narrow_calls_[i][j].load(std::memory_order_relaxed);
+            is_first = false;
+        }
+    }
+    out << "},\n  \"skipped_narrow_phase_calls\": " << skipped_calls() << ",\n";
+
+    //rates are parts of all tests of this pair kind
+    out << "  \"plane_early_outs\": {";
+    for(int kind = 0; kind < 3; ++kind) {
+        uint64_t tests[3];
+        for(int result = 0; result < 3; ++result) {
+            tests[result] = plane_tests_[kind][result].load(std::memory_order_relaxed);
+        }
+        const uint64_t total = tests[0] + tests[1] + tests[2];
+        out << (kind > 0 ? ", " : "") << "\"triangle_" << KIND_NAMES[kind] << "\": {"
+            << "\"tests\": " << total
+            << ", \"first_plane_rate\": " << rate(tests[FIRST_PLANE_REJECT], total);
+        if(kind == TRIANGLE) out << ", \"second_plane_rate\": " << rate(tests[SECOND_PLANE_REJECT], total);
+        out << "}";
+    }
+    out << "},\n";
+
+    out << "  \"peak_memory_bytes\": " << peak_memory() << "\n";
+    out << "}\n";
+}
+
+} //namespace geometry
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+#include "geometry.h"
+#include "tri_tri_kernel.h"
+
+namespace geometry {
+
+//--------------------------------------Finder_Stats-------------------------------
+
+//PARSE_PHASE and STORAGE_PHASE (classification of objects by kinds) are measured
+//by the caller, the finder measures search and its narrow phase
+enum finder_phase {PARSE_PHASE, STORAGE_PHASE, NARROW_PHASE};
+
+//Statistics of search for diagnosing slow inputs. Finder collects them only
+//when Finder_Settings::stats points to this object, then it costs a clock per
+//narrow phase test and a plane test per pair more. Counters are updated concurrently.
+//With several threads narrow phase time is summed over threads,
+//broad phase is search time without narrow phase, so it's exact for one thread.
+class Finder_Stats final {
+public:
+    static const size_t PHASES_NUM = 3;
+    static const size_t HISTOGRAM_SIZE = 64; //the last bin takes all bigger values
+private:
+    std::atomic<uint64_t> phases_ns_[PHASES_NUM];
+    std::atomic<uint64_t> search_ns_;
+    //plane split engine: number of splits at every recursion depth and
+    //number of split subsets with size in [2^k, 2^(k + 1))
+    std::atomic<uint64_t> depths_[HISTOGRAM_SIZE];
+    std::atomic<uint64_t> subset_sizes_[HISTOGRAM_SIZE];
+    //subsets which planes couldn't split and their objects
+    std::atomic<uint64_t> unsplit_subsets_;
+    std::atomic<uint64_t> unsplit_objects_;
+    //[kind][other kind] with kind <= other kind
+    std::atomic<uint64_t> narrow_calls_[3][3];
+    std::atomic<uint64_t> skipped_calls_;
+    //pairs of triangle with object of other kind by plane_test_result
+    std::atomic<uint64_t> plane_tests_[3][3];
+
+    static uint64_t to_ns(double seconds);
+public:
+    Finder_Stats();
+    Finder_Stats(const Finder_Stats&) = delete;
+    Finder_Stats& operator=(const Finder_Stats&) = delete;
+
+    void add_phase_time(finder_phase phase, double seconds);
+    void add_search_time(double seconds);
+    void add_split(size_t depth, size_t subset_size);
+    void add_unsplit_subset(size_t subset_size);
+    void add_narrow_calls(g_obj_type type1, g_obj_type type2, uint64_t calls_num = 1);
+    void add_skipped_calls(uint64_t calls_num);
+    void add_plane_test(g_obj_type other_type, plane_test_result result);
+
+    double phase_time(finder_phase phase) const;
+    double search_time() const;
+    uint64_t narrow_calls(g_obj_type type1, g_obj_type type2) const;
+    uint64_t skipped_calls() const { return skipped_calls_.load(std::memory_order_relaxed); }
+
+    //peak resident memory of process in bytes, 0 if system doesn't tell it
+    static uint64_t peak_memory();
+    void write_json(std::ostream& out) const;
+};
+
+//adds its lifetime to phase, it does nothing without stats
+class Phase_Timer final {
+private:
+    Finder_Stats* stats_;
+    finder_phase phase_;
+    std::chrono::steady_clock::time_point start_;
+public:
+    Phase_Timer(Finder_Stats* stats, finder_phase phase): stats_(stats), phase_(phase) {
+        if(stats_ != nullptr) start_ = std::chrono::steady_clock::now();
+    }
+    Phase_Timer(const Phase_Timer&) = delete;
+    Phase_Timer& operator=(const Phase_Timer&) = delete;
+    ~Phase_Timer() {
+        if(stats_ == nullptr) return;
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start_;
+        stats_->add_phase_time(phase_, time.count());
+    }
+};
+
+} //namespace geometry
@@ -0,0 +1,117 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "fixed_decimal.h"
+#include "exact_predicates.h"
+
+namespace geometry {
+
+//------------------------------------Fixed_Decimal--------------------------------
+
+namespace {
+
+const double POWERS_OF_TEN[MAX_DECIMAL_DIGITS + 1] = {1e0, 1e1, 1e2, 1e3, 1e4,
+                                                      1e5, 1e6, 1e7, 1e8, 1e9};
+
+//coordinate read from decimal text and multiplied by power of ten
+//is rounded twice, so it's a few units of last place away from integer
+bool is_near_integer(double scaled) {
+    const double error = 4 * std::numeric_limits<double>::epsilon() * fabs(scaled);
+    return fabs(scaled - std::nearbyint(scaled)) <= error;
+}
+
+bool is_grid_coord(double coord) {
+    return (coord == std::nearbyint(coord)) && (fabs(coord) <= MAX_INTEGER_COORD);
+}
+
+template <typename F>
+void for_each_point(const std::vector<Undefined_Object>& objects, F func) {
+    for(const Undefined_Object& obj : objects) {
+        func(obj.p1());
+        func(obj.p2());
+        func(obj.p3());
+    }
+}
+
+} //namespace
+
+int detect_decimal_digits(const std::vector<Undefined_Object>& objects) {
+    //every coordinate needs some digits, the answer is the biggest of them
+    int digits = 0;
+    bool is_found = true;
+    auto fit_coord = [&](double coord) {
+        while(!is_near_integer(coord * POWERS_OF_TEN[digits])) {
+            if(digits == MAX_DECIMAL_DIGITS) {
+                is_found = false;
+                return;
+            }
+            ++digits;
+        }
+    };
+    for_each_point(objects, [&](const point& p) {
+        if(!is_found) return;
+        fit_coord(p.x());
+        fit_coord(p.y());
+        fit_coord(p.z());
+    });
+    if(!is_found) return -1;
+
+    //more digits only make grid coordinates bigger
+    bool is_fitting = true;
+    for_each_point(objects, [&](const point& p) {
+        const double bound = MAX_INTEGER_COORD / POWERS_OF_TEN[digits];
+        if((fabs(p.x()) > bound) || (fabs(p.y()) > bound) || (fabs(p.z()) > bound)) {
+            is_fitting = false;
+        }
+    });
+    return is_fitting ? digits : -1;
+}
+
+std::vector<Undefined_Object> to_decimal_grid(const std::vector<Undefined_Object>& objects,
+                                              int digits) {
+    if((digits < 0) || (digits > MAX_DECIMAL_DIGITS)) {
+        throw std::invalid_argument("unsupported number of decimal digits");
+    }
+
+    auto grid_point = [scale = POWERS_OF_TEN[digits]](const point& p) {
+        const double coords[3] = {std::nearbyint(p.x() * scale), std::nearbyint(p.y() * scale),
+                                  std::nearbyint(p.z() * scale)};
+        for(double coord : coords) {
+            if(!is_grid_coord(coord)) {
+                throw std::invalid_argument("coordinate is too big for integer grid");
+            }
+        }
+        return point(coords[0], coords[1], coords[2]);
+    };
+
+    std::vector<Undefined_Object> grid_objects;
+    grid_objects.reserve(objects.size());
+    for(const Undefined_Object& obj : objects) {
+        grid_objects.push_back(Undefined_Object(grid_point(obj.p1()), grid_point(obj.p2()),
+                                                grid_point(obj.p3())));
+    }
+    return grid_objects;
+}
+
+bool is_integer_grid(const Geometry_Object_Storage& objects) {
+    auto is_grid_point = [](const point& p) {
+        return is_grid_coord(p.x()) && is_grid_coord(p.y()) && is_grid_coord(p.z());
+    };
+    for(const Triangle_Record& t : objects.triangles()) {
+        for(int vertex = 0; vertex < 3; ++vertex) {
+            if(!is_grid_point(t.vertex(vertex))) return false;
+        }
+    }
+    for(const Object_Cut& c : objects.cuts()) {
+        if(!is_grid_point(c.p_begin()) || !is_grid_point(c.p_end())) return false;
+    }
+    for(const Object_Point& p : objects.points()) {
+        if(!is_grid_point(p)) return false;
+    }
+    return true;
+}
+
+} //namespace geometry
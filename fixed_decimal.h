@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+
+namespace geometry {
+
+//------------------------------------Fixed_Decimal--------------------------------
+
+//Inputs written with a fixed number of digits after decimal point (Triangles_Generator
+//writes two of them) are points of integer grid when they are multiplied by 10^digits.
+//Objects on this grid are checked by INTEGER_PREDICATES in integer arithmetic, so
+//answers are exact for decimal values of input, not for their roundings to double.
+//Scale doesn't change answers of exact predicates, so numbers of intersecting
+//objects on grid are the answer for input objects.
+
+const int MAX_DECIMAL_DIGITS = 9;
+
+//the least number of digits which keeps every coordinate of objects,
+//-1 if there is no such number or grid coordinates are bigger than MAX_INTEGER_COORD
+int detect_decimal_digits(const std::vector<Undefined_Object>& objects);
+
+//objects with coordinates multiplied by 10^digits and rounded to integers,
+//throws std::invalid_argument if grid coordinates are bigger than MAX_INTEGER_COORD
+std::vector<Undefined_Object> to_decimal_grid(const std::vector<Undefined_Object>& objects,
+                                              int digits);
+
+//every coordinate of stored objects can be checked by INTEGER_PREDICATES
+bool is_integer_grid(const Geometry_Object_Storage& objects);
+
+//coordinates of integer grid, they are exact in doubles
+inline void grid_coords(const double coords[3], int32_t grid[3]) {
+    for(int axis = 0; axis < 3; ++axis) grid[axis] = static_cast<int32_t>(coords[axis]);
+}
+
+} //namespace geometry
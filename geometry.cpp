@@ -83,12 +83,15 @@ Plane::Plane(const point &p1, const point &p2, const point &p3) {
 }
 
 g_obj_pos planes_pos(const Plane &pl1, const Plane &pl2) {
-    if((fabs(pl1.A() - pl2.A()) > DOUBLE_GAP) ||
-       (fabs(pl1.B() - pl2.B()) > DOUBLE_GAP)) {
+    //normal sign depends on order of points, so planes match with opposite normals too
+    const double sign = (pl1.A() * pl2.A() + pl1.B() * pl2.B() + pl1.C() * pl2.C() < 0) ? -1 : 1;
+    if((fabs(pl1.A() - sign * pl2.A()) > DOUBLE_GAP) ||
+       (fabs(pl1.B() - sign * pl2.B()) > DOUBLE_GAP) ||
+       (fabs(pl1.C() - sign * pl2.C()) > DOUBLE_GAP)) {
         return COMMON;
     }
 
-    if(abs(pl1.D() - pl2.D()) > DOUBLE_GAP) {
+    if(fabs(pl1.D() - sign * pl2.D()) > DOUBLE_GAP) {
         return PARALLEL;
     }
 
@@ -158,23 +161,17 @@ bool is_point_on_plane(const Plane &pl, const point& p) {
 //-------------------------------------------Triangle------------------------------
 
 bool Triangle_2d::is_in_triangle(const point_2d &p) const {
-    vec_2d v1(p1(), p2());
-    vec_2d v2(p1(), p);
-    double a1 = v1.x() * v2.y() - v1.y() * v2.x();
-    v1 = vec_2d(p2(), p3());
-    v2 = vec_2d(p2(), p);
-    double a2 = v1.x() * v2.y() - v1.y() * v2.x();
-    v1 = vec_2d(p3(), p1());
-    v2 = vec_2d(p3(), p);
-    double a3 = v1.x() * v2.y() - v1.y() * v2.x();
-
-    if(a1 * a2 < 0) {
-        return false;
-    }
-    if(a2 * a3 < 0) {
-        return false;
+    //signed distances from p to lines of sides: they have one sign if p is inside
+    const point_2d* vertexes[3] = {&p1_, &p2_, &p3_};
+    bool is_left = true, is_right = true;
+    for(int i = 0; i < 3; ++i) {
+        vec_2d v1(*vertexes[i], *vertexes[(i + 1) % 3]);
+        vec_2d v2(*vertexes[i], p);
+        double dist = (v1.x() * v2.y() - v1.y() * v2.x()) / v1.length();
+        if(dist < -DOUBLE_GAP) is_left = false;
+        if(dist > DOUBLE_GAP) is_right = false;
     }
-    return true;
+    return is_left || is_right;
 }
 
 bool is_cut_and_triangle_intersects_on_plane(const Triangle &t, const Cut &c) {
@@ -288,4 +285,69 @@ bool is_triangles_intersects_2d(const Triangle_2d &t1, const Triangle_2d &t2) {
 
     return false;
 }
+
+
+
+
+//---------------------------------------Bounding_Box------------------------------
+
+Bounding_Box::Bounding_Box() {
+    for(int i = 0; i < 3; ++i) {
+        low_[i] = INFINITY;
+        high_[i] = -INFINITY;
+    }
+}
+
+Bounding_Box::Bounding_Box(const point& p) {
+    low_[0] = p.x() - DOUBLE_GAP;
+    low_[1] = p.y() - DOUBLE_GAP;
+    low_[2] = p.z() - DOUBLE_GAP;
+    high_[0] = p.x() + DOUBLE_GAP;
+    high_[1] = p.y() + DOUBLE_GAP;
+    high_[2] = p.z() + DOUBLE_GAP;
+}
+
+Bounding_Box::Bounding_Box(const Cut& c): Bounding_Box(c.p_begin()) {
+    extend(Bounding_Box(c.p_end()));
+}
+
+Bounding_Box::Bounding_Box(const Triangle& t): Bounding_Box(t.p1()) {
+    extend(Bounding_Box(t.p2()));
+    extend(Bounding_Box(t.p3()));
+}
+
+void Bounding_Box::extend(const point& p) {
+    const double coords[3] = {p.x(), p.y(), p.z()};
+    for(int i = 0; i < 3; ++i) {
+        if(coords[i] < low_[i]) low_[i] = coords[i];
+        if(coords[i] > high_[i]) high_[i] = coords[i];
+    }
+}
+
+void Bounding_Box::extend(const Bounding_Box& box) {
+    for(int i = 0; i < 3; ++i) {
+        if(box.low_[i] < low_[i]) low_[i] = box.low_[i];
+        if(box.high_[i] > high_[i]) high_[i] = box.high_[i];
+    }
+}
+
+double Bounding_Box::surface_area() const {
+    if(is_empty()) return 0;
+    double dx = extent(0), dy = extent(1), dz = extent(2);
+    return 2 * (dx * dy + dy * dz + dz * dx);
+}
+
+int Bounding_Box::largest_axis() const {
+    if((extent(0) >= extent(1)) && (extent(0) >= extent(2))) return 0;
+    if(extent(1) >= extent(2)) return 1;
+    return 2;
+}
+
+bool is_boxes_intersects(const Bounding_Box &b1, const Bounding_Box &b2) {
+    for(int i = 0; i < 3; ++i) {
+        if((b1.high(i) < b2.low(i)) || (b2.high(i) < b1.low(i))) return false;
+    }
+    return true;
+}
+
 } //namespace geometry
@@ -11,7 +11,7 @@
 namespace geometry {
 
 enum g_obj_pos {COMMON, PARALLEL, MATCH};
-//enum g_obj_type {TRIANGLE, CUT, POINT};
+enum g_obj_type {TRIANGLE, CUT, POINT};
 
 const double DOUBLE_GAP = 0.000001;
 
@@ -202,6 +202,8 @@ public:
     double D() const { return d; }
 
     Plane(const point &p1, const point &p2, const point &p3);
+    //normal (A, B, C) must be normalized already
+    Plane(double A, double B, double C, double D): a(A), b(B), c(C), d(D) {}
 
     int point_side_plane(const point& p) const {
         double k = p.x() * a + p.y() * b + p.z() * c + d;
@@ -240,6 +242,9 @@ public:
         p1_(p1), p2_(p2), p3_(p3), pl_(Plane(p1, p2, p3)) {
         //matching points checked in Plane constrcutor
     }
+    //plane is taken as is, it must be the plane of points
+    Triangle(const point& p1, const point& p2, const point& p3, const Plane& pl):
+        p1_(p1), p2_(p2), p3_(p3), pl_(pl) {}
     virtual ~Triangle() {}
 
     void print() const {
@@ -279,4 +284,35 @@ bool is_cut_and_triangle_intersects_2d(const Triangle_2d &t, const Cut_2d &c);
 bool is_triangles_intersects_on_plane(const Triangle &t1, const Triangle &t2);
 bool is_triangles_intersects_2d(const Triangle_2d &t1, const Triangle_2d &t2);
 
+
+
+//-------------------------------------Bounding_Box--------------------------------
+
+//axis aligned box, every constructed box is widened by DOUBLE_GAP
+//so objects which touch each other with tolerance have intersecting boxes
+class Bounding_Box final {
+private:
+    double low_[3];
+    double high_[3];
+public:
+    double low(int axis) const { return low_[axis]; }
+    double high(int axis) const { return high_[axis]; }
+    double center(int axis) const { return (low_[axis] + high_[axis]) / 2; }
+    double extent(int axis) const { return high_[axis] - low_[axis]; }
+
+    Bounding_Box(); //empty box, can be extended
+    explicit Bounding_Box(const point& p);
+    explicit Bounding_Box(const Cut& c);
+    explicit Bounding_Box(const Triangle& t);
+
+    void extend(const point& p);
+    void extend(const Bounding_Box& box);
+
+    bool is_empty() const { return low_[0] > high_[0]; }
+    double surface_area() const;
+    int largest_axis() const;
+};
+
+bool is_boxes_intersects(const Bounding_Box &b1, const Bounding_Box &b2);
+
 } //namespace geometry
@@ -50,20 +50,8 @@ bool is_points_match(const point &p1, const point &p2) {
 }
 
 bool is_points_on_one_line(const point &p1, const point &p2, const point &p3) {
-    vec v1(p1, p2);
-    vec v2(p1, p3);
-    v1.normalize();
-    v2.normalize();
-    if(fabs(fabs(v1.x()) - fabs(v2.x())) > DOUBLE_GAP) {
-        return false;
-    }
-    if(fabs(fabs(v1.y()) - fabs(v2.y())) > DOUBLE_GAP) {
-        return false;
-    }
-    if(fabs(fabs(v1.z()) - fabs(v2.z())) > DOUBLE_GAP) {
-        return false;
-    }
-    return true;
+    //matching points are on one line too
+    return vec::is_parallel(vec(p1, p2), vec(p1, p3));
 }
 
 point_2d& point_2d::operator+=(const vec_2d& v)& {
@@ -103,17 +91,8 @@ bool is_points_match(const point_2d &p1, const point_2d &p2) {
 }
 
 bool is_points_on_one_line(const point_2d &p1, const point_2d &p2, const point_2d &p3) {
-    vec_2d v1(p1, p2);
-    vec_2d v2(p1, p3);
-    v1.normalize();
-    v2.normalize();
-    if(fabs(fabs(v1.x()) - fabs(v2.x())) > DOUBLE_GAP) {
-        return false;
-    }
-    if(fabs(fabs(v1.y()) - fabs(v2.y())) > DOUBLE_GAP) {
-        return false;
-    }
-    return true;
+    //matching points are on one line too
+    return vec_2d::is_parallel(vec_2d(p1, p2), vec_2d(p1, p3));
 }
 
 
@@ -190,10 +169,8 @@ bool vec::is_parallel(const vec& v1, const vec& v2) {
     v1_dir.normalize();
     v2_dir.normalize();
 
-    if((fabs(v1_dir.x_ - v2_dir.x_) < DOUBLE_GAP) &&
-       (fabs(v1_dir.y_ - v2_dir.y_) < DOUBLE_GAP)) { return true; }
-
-    return false;
+    //directions may be opposite
+    return mult_vec(v1_dir, v2_dir).is_null();
 }
 
 vec mult_vec(const vec &v1, const vec &v2) {
@@ -271,9 +248,8 @@ bool vec_2d::is_parallel(const vec_2d& v1, const vec_2d& v2) {
     v1_dir.normalize();
     v2_dir.normalize();
 
-    if(fabs(v1_dir.x_ - v2_dir.x_) < DOUBLE_GAP) { return true; }
-
-    return false;
+    //directions may be opposite
+    return fabs(v1_dir.x_ * v2_dir.y_ - v1_dir.y_ * v2_dir.x_) < DOUBLE_GAP;
 }
 
 } //namespace geometry
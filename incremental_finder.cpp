@@ -0,0 +1,230 @@
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "incremental_finder.h"
+#include "narrow_phase.h"
+
+namespace geometry {
+
+Incremental_Finder::Incremental_Finder(Geometry_Object_Storage objects, double cell_size):
+    objects_(std::move(objects)),
+    cell_size_(cell_size)
+{
+    const size_t sizes[3] = {objects_.triangles().size(), objects_.cuts().size(),
+                             objects_.points().size()};
+    const g_obj_type types[3] = {TRIANGLE, CUT, POINT};
+
+    if(cell_size_ <= 0) {
+        //the same choice as in Uniform_Grid: most objects touch a few cells
+        std::vector<double> extents;
+        extents.reserve(objects_.capacity());
+        for(int kind = 0; kind < 3; ++kind) {
+            for(size_t i = 0; i < sizes[kind]; ++i) {
+                Bounding_Box box = stored_object_box(objects_, types[kind], i);
+                extents.push_back(box.extent(box.largest_axis()));
+            }
+        }
+        cell_size_ = 0;
+        if(!extents.empty()) {
+            auto median = extents.begin() + extents.size() / 2;
+            std::nth_element(extents.begin(), median, extents.end());
+            cell_size_ = *median;
+        }
+        if(cell_size_ <= 0) cell_size_ = 1;
+    }
+
+    //every object is checked with objects added before it
+    entries_.reserve(objects_.capacity());
+    for(int kind = 0; kind < 3; ++kind) {
+        for(size_t i = 0; i < sizes[kind]; ++i) {
+            insert(stored_object_number(objects_, types[kind], i), types[kind], i);
+        }
+    }
+}
+
+int64_t Incremental_Finder::cell_coord(double coord) const {
+    const double c = floor(coord / cell_size_);
+    if(c < -MAX_CELL_COORD) return -MAX_CELL_COORD;
+    if(c > MAX_CELL_COORD) return MAX_CELL_COORD;
+    return static_cast<int64_t>(c);
+}
+
+Incremental_Finder::Cells_Range Incremental_Finder::cells_range(const Bounding_Box& box) const {
+    Cells_Range range;
+    for(int axis = 0; axis < 3; ++axis) {
+        range.low[axis] = cell_coord(box.low(axis));
+        range.high[axis] = cell_coord(box.high(axis));
+    }
+    return range;
+}
+
+bool Incremental_Finder::is_oversized(const Cells_Range& range) const {
+    size_t cells_num = 1;
+    for(int axis = 0; axis < 3; ++axis) {
+        const uint64_t width = static_cast<uint64_t>(range.high[axis] - range.low[axis]) + 1;
+        if(width > MAX_CELLS_PER_OBJECT) return true;
+        cells_num *= width;
+    }
+    return cells_num > MAX_CELLS_PER_OBJECT;
+}
+
+Incremental_Finder::Object_Entry& Incremental_Finder::entry(size_t num) {
+    auto it = entries_.find(num);
+    if(it == entries_.end()) throw std::invalid_argument("no object with this number");
+    return it->second;
+}
+
+const Incremental_Finder::Object_Entry& Incremental_Finder::entry(size_t num) const {
+    auto it = entries_.find(num);
+    if(it == entries_.end()) throw std::invalid_argument("no object with this number");
+    return it->second;
+}
+
+template <typename F>
+void Incremental_Finder::for_each_neighbour(Object_Entry& e, F func) {
+    //object in several cells is met once: every search has its own number
+    const uint64_t search = ++searches_num_;
+    e.last_search = search;
+    auto visit = [&](Object_Entry& other) {
+        if(other.last_search == search) return;
+        other.last_search = search;
+        if(is_boxes_intersects(e.box, other.box)) func(other);
+    };
+
+    if(e.is_oversized) {
+        for(auto& other : entries_) {
+            visit(other.second);
+        }
+        return;
+    }
+
+    const Cells_Range range = cells_range(e.box);
+    for(int64_t x = range.low[0]; x <= range.high[0]; ++x) {
+        for(int64_t y = range.low[1]; y <= range.high[1]; ++y) {
+            for(int64_t z = range.low[2]; z <= range.high[2]; ++z) {
+                auto cell = cells_.find(Cell_Key{x, y, z});
+                if(cell == cells_.end()) continue;
+                for(Object_Entry* other : cell->second) {
+                    visit(*other);
+                }
+            }
+        }
+    }
+    for(Object_Entry* other : oversized_) {
+        visit(*other);
+    }
+}
+
+bool Incremental_Finder::check_objects(const Object_Entry& e1, const Object_Entry& e2) const {
+    if(e1.number > e2.number) return check_objects(e2, e1);
+    return visit_stored_object(objects_, e1.type, e1.index, [this, &e2](const auto& obj1) {
+        return visit_stored_object(objects_, e2.type, e2.index,
+                                   [&obj1](const auto& obj2) { return check_pair(obj1, obj2); });
+    });
+}
+
+void Incremental_Finder::insert(size_t num, g_obj_type type, size_t index) {
+    Object_Entry new_entry{num, type, index, stored_object_box(objects_, type, index)};
+    const Cells_Range range = cells_range(new_entry.box);
+    new_entry.is_oversized = is_oversized(range);
+
+    auto inserted = entries_.emplace(num, new_entry);
+    if(inserted.second == false) throw std::invalid_argument("object number is taken");
+    Object_Entry& e = inserted.first->second;
+
+    for_each_neighbour(e, [this, &e](Object_Entry& other) {
+        if(check_objects(e, other)) {
+            ++e.intersections_num;
+            ++other.intersections_num;
+        }
+    });
+
+    if(e.is_oversized) {
+        oversized_.push_back(&e);
+        return;
+    }
+    for(int64_t x = range.low[0]; x <= range.high[0]; ++x) {
+        for(int64_t y = range.low[1]; y <= range.high[1]; ++y) {
+            for(int64_t z = range.low[2]; z <= range.high[2]; ++z) {
+                cells_[Cell_Key{x, y, z}].push_back(&e);
+            }
+        }
+    }
+}
+
+void Incremental_Finder::erase(size_t num) {
+    Object_Entry& e = entry(num);
+
+    //the same checks as in insert find every partner again
+    for_each_neighbour(e, [this, &e](Object_Entry& other) {
+        if(check_objects(e, other)) {
+            assert((e.intersections_num > 0) && (other.intersections_num > 0));
+            --e.intersections_num;
+            --other.intersections_num;
+        }
+    });
+    assert(e.intersections_num == 0);
+
+    auto erase_from = [&e](std::vector<Object_Entry*>& entries) {
+        auto it = std::find(entries.begin(), entries.end(), &e);
+        assert(it != entries.end());
+        *it = entries.back();
+        entries.pop_back();
+    };
+    if(e.is_oversized) {
+        erase_from(oversized_);
+    }
+    else {
+        const Cells_Range range = cells_range(e.box);
+        for(int64_t x = range.low[0]; x <= range.high[0]; ++x) {
+            for(int64_t y = range.low[1]; y <= range.high[1]; ++y) {
+                for(int64_t z = range.low[2]; z <= range.high[2]; ++z) {
+                    auto cell = cells_.find(Cell_Key{x, y, z});
+                    assert(cell != cells_.end());
+                    erase_from(cell->second);
+                    if(cell->second.empty()) cells_.erase(cell);
+                }
+            }
+        }
+    }
+
+    //the last object of this kind takes place of the removed one in storage
+    const size_t sizes[3] = {objects_.triangles().size(), objects_.cuts().size(),
+                             objects_.points().size()};
+    const size_t last_num = stored_object_number(objects_, e.type, sizes[e.type] - 1);
+    objects_.remove(e.type, e.index);
+    if(last_num != num) entry(last_num).index = e.index;
+
+    entries_.erase(num);
+}
+
+void Incremental_Finder::add(size_t num, const Undefined_Object& obj) {
+    if(contains(num)) throw std::invalid_argument("object number is taken");
+    std::pair<g_obj_type, size_t> place = objects_.add(obj, num);
+    insert(num, place.first, place.second);
+}
+
+void Incremental_Finder::remove(size_t num) {
+    erase(num);
+}
+
+void Incremental_Finder::move(size_t num, const Undefined_Object& obj) {
+    erase(num);
+    add(num, obj);
+}
+
+std::vector<size_t> Incremental_Finder::intersecting_objects() const {
+    std::vector<size_t> numbers;
+    for(const auto& e : entries_) {
+        if(e.second.intersections_num > 0) numbers.push_back(e.first);
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+} //namespace geometry
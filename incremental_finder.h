@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+
+namespace geometry {
+
+//-----------------------------------Incremental_Finder----------------------------
+
+//Intersections of scene which is edited by a few objects at a time.
+//Objects are found by their numbers and kept in a hashed uniform grid.
+//Every object has a number of intersecting objects, so adding, removing or
+//moving an object checks only objects near it: their numbers are updated
+//and flags of objects which lost their last partner are cleared.
+class Incremental_Finder final {
+private:
+    static const size_t MAX_CELLS_PER_OBJECT = 64;          //bigger objects are checked with all
+    static const int64_t MAX_CELL_COORD = int64_t(1) << 40; //far cells are clamped
+
+    struct Cell_Key {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+        bool operator==(const Cell_Key& key) const {
+            return (x == key.x) && (y == key.y) && (z == key.z);
+        }
+    };
+
+    struct Cell_Key_Hash {
+        size_t operator()(const Cell_Key& key) const {
+            uint64_t h = static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ull;
+            h ^= static_cast<uint64_t>(key.y) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+            h ^= static_cast<uint64_t>(key.z) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h);
+        }
+    };
+
+    struct Object_Entry {
+        size_t number;
+        g_obj_type type;
+        size_t index;                   //in storage of its type
+        Bounding_Box box;
+        size_t intersections_num = 0;
+        bool is_oversized = false;
+        uint64_t last_search = 0;       //search which met the object last, it's met once
+    };
+
+    struct Cells_Range {
+        int64_t low[3];
+        int64_t high[3];
+    };
+
+    Geometry_Object_Storage objects_;
+    double cell_size_;
+    //entries don't move in map, so cells keep pointers to them
+    std::unordered_map<size_t, Object_Entry> entries_; //by object number
+    std::unordered_map<Cell_Key, std::vector<Object_Entry*>, Cell_Key_Hash> cells_;
+    std::vector<Object_Entry*> oversized_;
+    uint64_t searches_num_ = 0;
+
+    int64_t cell_coord(double coord) const;
+    Cells_Range cells_range(const Bounding_Box& box) const;
+    bool is_oversized(const Cells_Range& range) const;
+    Object_Entry& entry(size_t num);
+    const Object_Entry& entry(size_t num) const;
+
+    //func(entry) for every other object whose box intersects box of e
+    template <typename F>
+    void for_each_neighbour(Object_Entry& e, F func);
+    //objects are checked in order of their numbers,
+    //so the pair gives the same result when it's added and when it's removed
+    bool check_objects(const Object_Entry& e1, const Object_Entry& e2) const;
+
+    //object is in storage already
+    void insert(size_t num, g_obj_type type, size_t index);
+    void erase(size_t num);
+public:
+    //numbers of objects in storage are their numbers in finder,
+    //cell_size 0 means median extent of objects boxes
+    explicit Incremental_Finder(Geometry_Object_Storage objects, double cell_size = 0);
+
+    const Geometry_Object_Storage& objects() const { return objects_; }
+    size_t objects_num() const { return entries_.size(); }
+    bool contains(size_t num) const { return entries_.count(num) > 0; }
+
+    //number must be free, triangle numbers must fit into uint32_t
+    void add(size_t num, const Undefined_Object& obj);
+    void remove(size_t num);
+    void move(size_t num, const Undefined_Object& obj);
+
+    size_t intersections_num(size_t num) const { return entry(num).intersections_num; }
+    bool is_object_intersects(size_t num) const { return intersections_num(num) > 0; }
+    //sorted numbers of objects with intersections
+    std::vector<size_t> intersecting_objects() const;
+};
+
+} //namespace geometry
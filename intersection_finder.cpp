@@ -1,13 +1,33 @@
+#include <cstdint>
 #include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <typeinfo>
 
 #include "intersection_finder.h"
 #include "geometry.h"
+#include "bvh.h"
+#include "uniform_grid.h"
+#include "tri_tri_kernel.h"
+#include "plane_classifier.h"
+#include "narrow_phase.h"
+#include "exact_kernel.h"
+#include "fixed_decimal.h"
 
 namespace geometry {
 
 bool Geometry_Object::check_intersection(const Triangle &t1, const Triangle &t2) {
+    return is_triangles_intersects(make_triangle_coords(t1), make_triangle_coords(t2));
+}
+
+bool Geometry_Object::check_intersection_reference(const Triangle &t1, const Triangle &t2) {
     g_obj_pos p_pos = planes_pos(t1.pl(), t2.pl());
 
     if(p_pos == PARALLEL) return false;
@@ -78,58 +98,25 @@ bool Geometry_Object::check_intersection(const Triangle &t1, const Triangle &t2)
 }
 
 bool Geometry_Object::check_intersection(const Triangle &t, const Cut &c) {
-    g_obj_pos pos = cut_and_plane_pos(t.pl(), c);
-
-    if(pos == PARALLEL) return false;
-    if(pos == MATCH) return is_cut_and_triangle_intersects_on_plane(t, c);
-    assert(pos == COMMON);
-    point p = intersection_plane_and_line(t.pl(), c);
-
-    const vec& v = c.vec();
-    if((v.x() >= v.y()) && (v.x() >= v.z())) {
-        double k = (p.x() - c.p_begin().x()) / v.x();
-        if((k < 0) || (k > 1)) return false;
-    }
-    else if((v.y() >= v.z()) && (v.y() >= v.z())) {
-        double k = (p.y() - c.p_begin().y()) / v.y();
-        if((k < 0) || (k > 1)) return false;
-    }
-    else {
-        double k = (p.z() - c.p_begin().z()) / v.z();
-        if((k < 0) || (k > 1)) return false;
-    }
-
-    return check_intersection(t, p);
+    const Triangle_Coords coords = make_triangle_coords(t);
+    const point end = c.p_end();
+    const double c_begin[3] = {c.p_begin().x(), c.p_begin().y(), c.p_begin().z()};
+    const double c_end[3] = {end.x(), end.y(), end.z()};
+    return is_triangle_and_cut_intersects(coords, make_triangle_cache(coords), c_begin, c_end);
 }
 
 bool Geometry_Object::check_intersection(const Triangle &t, const point &p) {
-    if(is_point_on_plane(t.pl(), p) == false) return false;
-
-    vec a1 = mult_vec(vec(t.p1(), t.p2()), vec(t.p1(), p));
-    vec a2 = mult_vec(vec(t.p2(), t.p3()), vec(t.p2(), p));
-    vec a3 = mult_vec(vec(t.p3(), t.p1()), vec(t.p3(), p));
-
-    if((fabs(a1.x()) >= fabs(a1.y())) && (fabs(a1.x()) >= fabs(a1.z()))) {
-        if(a1.x() * a2.x() < 0) return false;
-        if(a2.x() * a3.x() < 0) return false;
-        return true;
-    }
-
-    if((fabs(a1.y()) >= fabs(a1.x())) && (fabs(a1.y()) >= fabs(a1.z()))) {
-        if(a1.y() * a2.y() < 0) return false;
-        if(a2.y() * a3.y() < 0) return false;
-        return true;
-    }
-
-    if(a1.z() * a2.z() < 0) return false;
-    if(a2.z() * a3.z() < 0) return false;
-    return true;
+    const Triangle_Coords coords = make_triangle_coords(t);
+    const double p_coords[3] = {p.x(), p.y(), p.z()};
+    return is_triangle_and_point_intersects(coords, make_triangle_cache(coords), p_coords);
 }
 
 bool Geometry_Object::check_intersection(const Cut &c1, const Cut &c2) {
     if(is_points_on_one_line(c1.p_begin(), c1.p_end(), c2.p_begin())) {
         if(check_intersection(c1, c2.p_begin()) == true) return true;
-        else return check_intersection(c1, c2.p_end());
+        if(check_intersection(c1, c2.p_end()) == true) return true;
+        //collinear c2 can cover c1 with both ends outside of it
+        return check_intersection(c2, c1.p_begin());
     }
 
     Plane pl(c1.p_begin(), c1.p_end(), c2.p_begin());
@@ -197,32 +184,67 @@ bool Geometry_Object::check_intersection(const point &p1, const point &p2) {
 
 Geometry_Object_Storage::Geometry_Object_Storage(const std::vector<Undefined_Object>& undef_objects) {
     for(size_t i = 0; i < undef_objects.size(); ++i) {
-        const Undefined_Object& cur_obj = undef_objects[i];
-
-        if(is_points_match(cur_obj.p1(), cur_obj.p2())) {
+        add(undef_objects[i], i);
+    }
+}
 
-            if(is_points_match(cur_obj.p1(), cur_obj.p3())) {
-                Object_Point p(cur_obj.p1(), i);
-                obj_point_storage_.push_back(p);
-                continue;
-            }
+std::pair<g_obj_type, size_t> Geometry_Object_Storage::add(const Undefined_Object& cur_obj,
+                                                           size_t number) {
+    if(is_points_match(cur_obj.p1(), cur_obj.p2())) {
 
-            Object_Cut c(Cut(cur_obj.p1(), cur_obj.p3()), i);
-            obj_cut_storage_.push_back(c);
-            continue;;
+        if(is_points_match(cur_obj.p1(), cur_obj.p3())) {
+            Object_Point p(cur_obj.p1(), number);
+            obj_point_storage_.push_back(p);
+            return std::make_pair(POINT, obj_point_storage_.size() - 1);
         }
 
-        if((is_points_match(cur_obj.p1(), cur_obj.p3())) ||
-           (is_points_match(cur_obj.p2(), cur_obj.p3()))) {
-            Object_Cut c(Cut(cur_obj.p1(), cur_obj.p2()), i);
-            obj_cut_storage_.push_back(c);
-            continue;;
-        }
+        Object_Cut c(Cut(cur_obj.p1(), cur_obj.p3()), number);
+        obj_cut_storage_.push_back(c);
+        return std::make_pair(CUT, obj_cut_storage_.size() - 1);
+    }
+
+    if((is_points_match(cur_obj.p1(), cur_obj.p3())) ||
+       (is_points_match(cur_obj.p2(), cur_obj.p3()))) {
+        Object_Cut c(Cut(cur_obj.p1(), cur_obj.p2()), number);
+        obj_cut_storage_.push_back(c);
+        return std::make_pair(CUT, obj_cut_storage_.size() - 1);
+    }
 
-        Object_Triangle t(Triangle(cur_obj.p1(), cur_obj.p2(), cur_obj.p3()), i);
-        obj_triangle_storage_.push_back(t);
+    //sliver triangle: the longest side covers the third point
+    //(the same check as in Plane constructor)
+    if(mult_vec(vec(cur_obj.p1(), cur_obj.p2()), vec(cur_obj.p1(), cur_obj.p3())).is_null()) {
+        const point* ends[3][2] = {{&cur_obj.p1(), &cur_obj.p2()},
+                                   {&cur_obj.p1(), &cur_obj.p3()},
+                                   {&cur_obj.p2(), &cur_obj.p3()}};
+        size_t longest = 0;
+        for(size_t k = 1; k < 3; ++k) {
+            if(vec(*ends[k][0], *ends[k][1]).length() >
+               vec(*ends[longest][0], *ends[longest][1]).length()) longest = k;
+        }
+        Object_Cut c(Cut(*ends[longest][0], *ends[longest][1]), number);
+        obj_cut_storage_.push_back(c);
+        return std::make_pair(CUT, obj_cut_storage_.size() - 1);
     }
 
+    Triangle_Record t(Triangle(cur_obj.p1(), cur_obj.p2(), cur_obj.p3()), number);
+    obj_triangle_storage_.push_back(t);
+    obj_triangle_cache_.push_back(make_triangle_cache(t.coords()));
+    return std::make_pair(TRIANGLE, obj_triangle_storage_.size() - 1);
+}
+
+void Geometry_Object_Storage::remove(g_obj_type type, size_t index) {
+    auto remove_from = [index](auto& storage) {
+        if(index >= storage.size()) throw std::invalid_argument("invalid object index");
+        if(index + 1 < storage.size()) storage[index] = storage.back();
+        storage.pop_back();
+    };
+
+    if(type == TRIANGLE) {
+        remove_from(obj_triangle_storage_);
+        remove_from(obj_triangle_cache_);
+    }
+    else if(type == CUT) remove_from(obj_cut_storage_);
+    else remove_from(obj_point_storage_);
 }
 
 
@@ -230,233 +252,786 @@ Geometry_Object_Storage::Geometry_Object_Storage(const std::vector<Undefined_Obj
 
 //-------------------------------------Intersection_Finder------------------------
 
-Intersection_Finder::Intersection_Finder(Geometry_Object_Storage objects):
+Intersection_Finder::Intersection_Finder(Geometry_Object_Storage objects,
+                                         Finder_Settings settings):
     num_of_objects_(objects.capacity()),
-    objects_(objects)
+    objects_(std::move(objects)),
+    settings_(settings),
+    intersection_flags_(num_of_objects_)
 {
-    intersection_flags_.reserve(num_of_objects_);
     for(size_t i = 0; i < num_of_objects_; ++i) {
-        intersection_flags_.push_back(false);
+        intersection_flags_[i].store(false, std::memory_order_relaxed);
+    }
+
+    if((settings_.predicates == INTEGER_PREDICATES) && !is_integer_grid(objects_)) {
+        throw std::invalid_argument("objects aren't on integer grid");
     }
+
+    //pairs of flagged objects are needed in pairs mode
+    if(is_pairs_mode()) settings_.flags_only = false;
 }
 
 Objects_and_Intersections Intersection_Finder::compute_intersections() {
-
-    std::vector<Geometry_Object*> p_objects(num_of_objects_);
-    size_t i = 0, j = 0;
-    while(i < objects_.triangles().size()) {
-        p_objects[j] = &((objects_.triangles())[i]);
-        ++i;
-        ++j;
+    const auto search_start = std::chrono::steady_clock::now();
+    std::unique_ptr<Work_Stealing_Pool> pool;
+    if(settings_.threads_num != 1) {
+        pool = std::make_unique<Work_Stealing_Pool>(settings_.threads_num);
+        pool_ = pool.get();
     }
-    i = 0;
-    while(i < objects_.cuts().size()) {
-        p_objects[j] = &((objects_.cuts())[i]);
-        ++i;
-        ++j;
+
+    try {
+        search();
+        if(pool_ != nullptr) pool_->wait(tasks_);
     }
-    i = 0;
-    while(i < objects_.points().size()) {
-        p_objects[j] = &((objects_.points())[i]);
-        ++i;
-        ++j;
+    catch(...) {
+        //tasks use this finder and the pool, so they must end before the pool does;
+        //the error which stopped the search is thrown, other errors of tasks are dropped
+        if(pool_ != nullptr) {
+            try {
+                pool_->wait(tasks_);
+            }
+            catch(...) {}
+        }
+        pool_ = nullptr;
+        throw;
     }
-    assert(j == num_of_objects_);
+    pool_ = nullptr;
 
-    compute_intersections_recursive_algorithm(p_objects);
+    if(settings_.stats != nullptr) {
+        std::chrono::duration<double> search_time = std::chrono::steady_clock::now() - search_start;
+        settings_.stats->add_search_time(search_time.count());
+    }
 
-    std::cout << iter1 << " " << iter2 << " " << iter3 << " " << iter4 << std::endl;
+    std::vector<bool> intersection_flags(num_of_objects_);
+    for(size_t k = 0; k < num_of_objects_; ++k) {
+        intersection_flags[k] = intersection_flags_[k].load(std::memory_order_relaxed);
+    }
 
     Objects_and_Intersections answer(std::move(objects_),
-                                     std::move(intersection_flags_));
+                                     std::move(intersection_flags));
     return answer;
 }
 
-void Intersection_Finder::compute_intersections_recursive_algorithm(
-        const std::vector<Geometry_Object*>& p_objects)
-{
-    if(p_objects.size() > 1) {
-        Geometry_Object* root_object = p_objects[0];
+void Intersection_Finder::search() {
+    if((settings_.engine == BVH_ENGINE) || (settings_.engine == GRID_ENGINE)) {
+        assert(num_of_objects_ <= UINT32_MAX);
 
-        if(typeid(*root_object) == typeid(Object_Triangle)) {
-            const Object_Triangle* root_t = static_cast<Object_Triangle*>(root_object);
+        std::vector<Object_Ref> refs;
+        refs.reserve(num_of_objects_);
+        for(size_t i = 0; i < objects_.triangles().size(); ++i) {
+            refs.push_back(Object_Ref{TRIANGLE, static_cast<uint32_t>(i)});
+        }
+        for(size_t i = 0; i < objects_.cuts().size(); ++i) {
+            refs.push_back(Object_Ref{CUT, static_cast<uint32_t>(i)});
+        }
+        for(size_t i = 0; i < objects_.points().size(); ++i) {
+            refs.push_back(Object_Ref{POINT, static_cast<uint32_t>(i)});
+        }
 
-            root_triangle_case(p_objects, root_t);
+        if(settings_.engine == BVH_ENGINE) bvh_algorithm(refs);
+        else grid_algorithm(refs);
+    }
+    else {
+        assert(settings_.engine == PLANE_SPLIT_ENGINE);
+        assert(num_of_objects_ <= UINT32_MAX);
+
+        Objects_Indexes indexes;
+        indexes.triangles.resize(objects_.triangles().size());
+        indexes.cuts.resize(objects_.cuts().size());
+        indexes.points.resize(objects_.points().size());
+        std::iota(indexes.triangles.begin(), indexes.triangles.end(), 0);
+        std::iota(indexes.cuts.begin(), indexes.cuts.end(), 0);
+        std::iota(indexes.points.begin(), indexes.points.end(), 0);
+
+        Subset all{Objects_Range{0, indexes.triangles.size()},
+                   Objects_Range{0, indexes.cuts.size()},
+                   Objects_Range{0, indexes.points.size()}};
+        if((settings_.scalar == FLOAT_SCALAR) && !is_exact_mode()) {
+            float_triangles_ = std::make_unique<Scalar_Triangles<float>>(objects_.triangles(),
+                                                                         settings_.recentre);
         }
 
-        else if(typeid(*root_object) == typeid(Object_Cut)) {
-            const Object_Cut* root_c = static_cast<Object_Cut*>(root_object);
+        Split_Planes upper_planes;
+        compute_intersections_recursive_algorithm(indexes, all, upper_planes, 0);
+    }
 
-            root_cut_case(p_objects, root_c);
-        }
+}
 
-        else {
-            assert(typeid(*root_object) == typeid(Object_Point));
-            const Object_Point* root_p = static_cast<Object_Point*>(root_object);
+namespace {
 
-            root_point_case(p_objects, root_p);
-        }
-    }
+//type of object is known at compile time in all functions below,
+//so there is no dispatching in loops over objects
+
+int side_plane(const Plane& pl, const Triangle_Record& t) { return t.side_plane(pl); }
+int side_plane(const Plane& pl, const Object_Cut& c) { return pl.cut_side_plane(c); }
+int side_plane(const Plane& pl, const Object_Point& p) { return pl.point_side_plane(p); }
+
+int exact_side(const double pl[3][3], const Triangle_Record& t) {
+    return triangle_side_exact(pl, t.coords().v);
+}
+int exact_side(const double pl[3][3], const Object_Cut& c) {
+    const point begin = c.p_begin(), end = c.p_end();
+    const double begin_coords[3] = {begin.x(), begin.y(), begin.z()};
+    const double end_coords[3] = {end.x(), end.y(), end.z()};
+    return cut_side_exact(pl, begin_coords, end_coords);
+}
+int exact_side(const double pl[3][3], const Object_Point& p) {
+    const double coords[3] = {p.x(), p.y(), p.z()};
+    return point_side_exact(pl, coords);
+}
+
+template <typename T>
+int side_plane(const Split_Plane& pl, const T& obj) {
+    return pl.is_exact ? exact_side(pl.v, obj) : side_plane(pl.pl, obj);
 }
 
-void Intersection_Finder::root_triangle_case(const std::vector<Geometry_Object*>& p_objects,
-                                             const Object_Triangle* root_t) {
+//cuts and points are checked with each other by Geometry_Object
+const Cut& shape(const Object_Cut& c) { return c; }
+const point& shape(const Object_Point& p) { return p; }
 
-    const Plane& pl = root_t->pl();
-    std::vector<Geometry_Object*> p_objects_new1;
-    std::vector<Geometry_Object*> p_objects_new2;
+//triangles crossing plane of triangle root, one list per thread
+std::vector<const Triangle_Record*>& crossing_triangles() {
+    thread_local std::vector<const Triangle_Record*> triangles;
+    return triangles;
+}
 
-    for(size_t i = 1; i < p_objects.size(); ++i) {
-        Geometry_Object* cur_obj = p_objects[i];
+//exact sides are taken relative to p1, p2, p3 and tolerance sides to pl
+Split_Plane split_plane(const Plane& pl, const point& p1, const point& p2, const point& p3,
+                        Split_Kind kind) {
+    Split_Plane answer{pl, {{p1.x(), p1.y(), p1.z()},
+                            {p2.x(), p2.y(), p2.z()},
+                            {p3.x(), p3.y(), p3.z()}}, kind.is_exact, kind.float_triangles, {}};
+    if(kind.float_triangles != nullptr) answer.float_pl = kind.float_triangles->plane(pl);
+    return answer;
+}
 
-        if(typeid(*cur_obj) == typeid(Object_Triangle)) {
-            const Object_Triangle* t = static_cast<Object_Triangle*>(cur_obj);
-            int k = pl.triangle_side_plane(*t);
+Split_Plane split_plane(const Triangle_Record& t, Split_Kind kind) {
+    return split_plane(t.pl(), t.p1(), t.p2(), t.p3(), kind);
+}
 
-            if(k != 1) p_objects_new2.push_back(cur_obj);
-            if(k != -1) p_objects_new1.push_back(cur_obj);
+Split_Plane axis_aligned_plane(int axis, double coord, Split_Kind kind) {
+    auto plane = [kind](const point& p1, const point& p2, const point& p3) {
+        return split_plane(Plane(p1, p2, p3), p1, p2, p3, kind);
+    };
+    if(axis == 0) return plane(point(coord, 0, 0), point(coord, 1, 0), point(coord, 0, 1));
+    if(axis == 1) return plane(point(0, coord, 0), point(0, coord, 1), point(1, coord, 0));
+    return plane(point(0, 0, coord), point(1, 0, coord), point(0, 1, coord));
+}
 
-            if(k == 0) {
-                if(Geometry_Object::check_intersection(*root_t, *t)) {
-                    intersection_flags_[p_objects[0]->number()] = true;
-                    intersection_flags_[cur_obj->number()] = true;
-                }
-            }
+//plane contains the cut, its normal is as close to the axis as possible
+Split_Plane plane_through_cut(const Cut& c, int axis, Split_Kind kind) {
+    const vec& d = c.vec();
+    const double d_coords[3] = {d.x(), d.y(), d.z()};
+    const double len2 = d.x() * d.x() + d.y() * d.y() + d.z() * d.z();
+
+    //axis almost parallel to the cut can't be the normal, the least aligned is taken
+    if(fabs(d_coords[axis]) * fabs(d_coords[axis]) > len2 / 2) {
+        axis = 0;
+        if(fabs(d_coords[1]) < fabs(d_coords[axis])) axis = 1;
+        if(fabs(d_coords[2]) < fabs(d_coords[axis])) axis = 2;
+    }
+
+    //normal is axis without its component along the cut
+    vec n(axis == 0 ? 1 : 0, axis == 1 ? 1 : 0, axis == 2 ? 1 : 0);
+    n -= d * (d_coords[axis] / len2);
+
+    //third point is far enough from the cut even for the shortest cuts
+    vec w = mult_vec(n, d);
+    w /= w.length() * sqrt(len2);
+    const Plane pl(c.p_begin(), c.p_end(), c.p_begin() + w);
 
+    //short offset can vanish in rounding at big coordinates,
+    //so exact plane is given by offset as long as the cut
+    return split_plane(pl, c.p_begin(), c.p_end(), c.p_begin() + w * len2, kind);
+}
+
+//sides[k] is side of object indexes[begin + k]
+template <typename T>
+void classify(const std::vector<T>& storage, const std::vector<uint32_t>& indexes,
+              size_t begin, size_t end, const Split_Plane& pl, int8_t* sides)
+{
+    for(size_t i = begin; i < end; ++i) {
+        sides[i - begin] = static_cast<int8_t>(side_plane(pl, storage[indexes[i]]));
+    }
+}
+
+//triangles cover the whole input at every level, so they are classified in batches
+void classify(const std::vector<Triangle_Record>& storage, const std::vector<uint32_t>& indexes,
+              size_t begin, size_t end, const Split_Plane& pl, int8_t* sides)
+{
+    classify_triangles(storage.data(), indexes.data() + begin, end - begin, pl, sides);
+}
+
+//side masks of range are computed before the range is reordered,
+//buffer is per thread and it's free again when partition returns
+template <typename T>
+int8_t* classify_range(const std::vector<T>& storage, const std::vector<uint32_t>& indexes,
+                       size_t begin, size_t end, const Split_Plane& pl)
+{
+    thread_local std::vector<int8_t> sides;
+    if(sides.size() < end - begin) sides.resize(end - begin);
+    classify(storage, indexes, begin, end, pl, sides.data());
+    return sides.data();
+}
+
+//three-way partition like in quicksort:
+//[range.begin, lower_end) - below the plane,
+//[lower_end, upper_begin) - crossing the plane, they belong to both subsets,
+//[upper_begin, range.end) - above the plane,
+//on_crossing is called for every crossing object
+template <typename T, typename F>
+std::pair<size_t, size_t> partition_kind_by_plane(const std::vector<T>& storage,
+                                                  std::vector<uint32_t>& indexes,
+                                                  size_t begin, size_t end,
+                                                  const Split_Plane& pl, F on_crossing)
+{
+    //sides are swapped together with indexes
+    int8_t* sides = classify_range(storage, indexes, begin, end, pl);
+    auto swap_objects = [&indexes, sides, begin](size_t i, size_t j) {
+        std::swap(indexes[i], indexes[j]);
+        std::swap(sides[i - begin], sides[j - begin]);
+    };
+
+    size_t lower_end = begin;
+    size_t upper_begin = end;
+    size_t i = begin;
+    while(i < upper_begin) {
+        int k = sides[i - begin];
+
+        if(k == -1) {
+            swap_objects(lower_end, i);
+            ++lower_end;
+            ++i;
             continue;
         }
 
-        if(typeid(*cur_obj) == typeid(Object_Cut)) {
-            const Object_Cut* c = static_cast<Object_Cut*>(cur_obj);
-            int k = pl.cut_side_plane(*c);
+        if(k == 1) {
+            --upper_begin;
+            swap_objects(i, upper_begin);
+            continue;
+        }
 
-            if(k != 1) p_objects_new2.push_back(cur_obj);
-            if(k != -1) p_objects_new1.push_back(cur_obj);
+        on_crossing(storage[indexes[i]]);
+        ++i;
+    }
 
-            if(k == 0) {
-                if(Geometry_Object::check_intersection(*root_t, *c)) {
-                    intersection_flags_[p_objects[0]->number()] = true;
-                    intersection_flags_[cur_obj->number()] = true;
-                }
-            }
+    return std::make_pair(lower_end, upper_begin);
+}
 
-            continue;
+//moves objects with needed side to the beginning of range
+template <typename T>
+size_t gather_side(const std::vector<T>& storage, std::vector<uint32_t>& indexes,
+                   size_t begin, size_t end, const Split_Plane& pl, int side)
+{
+    int8_t* sides = classify_range(storage, indexes, begin, end, pl);
+
+    size_t border = begin;
+    for(size_t i = begin; i < end; ++i) {
+        if(sides[i - begin] != side) continue;
+        std::swap(indexes[border], indexes[i]);
+        std::swap(sides[border - begin], sides[i - begin]);
+        ++border;
+    }
+    return border;
+}
+
+} //namespace
+
+template <typename T1, typename T2>
+bool Intersection_Finder::check_objects(const T1& obj1, const T2& obj2) const {
+    return check_pair(narrow_shape(obj1), narrow_shape(obj2), settings_.predicates, settings_.stats);
+}
+
+template <typename T>
+int Intersection_Finder::object_side(const Split_Plane& pl, const T& obj) const {
+    if constexpr(std::is_same<T, Triangle_Record>::value) {
+        if(pl.float_triangles != nullptr) {
+            const size_t index = &obj - objects_.triangles().data();
+            return triangle_side_plane(pl.float_pl, pl.float_triangles->triangles()[index]);
         }
+    }
+    return side_plane(pl, obj);
+}
 
-        assert(typeid(*cur_obj) == typeid(Object_Point));
-        const Object_Point* p = static_cast<Object_Point*>(cur_obj);
-        int k = pl.point_side_plane(*p);
+template <typename T>
+Bounding_Box Intersection_Finder::object_box(const T& obj) const {
+    if constexpr(std::is_same<T, Triangle_Record>::value) return triangle_cache(obj).box;
+    else return Bounding_Box(shape(obj));
+}
 
-        if(k != 1) p_objects_new2.push_back(cur_obj);
-        if(k != -1) p_objects_new1.push_back(cur_obj);
+template <typename T>
+point Intersection_Finder::box_center(const T& obj) const {
+    Bounding_Box box = object_box(obj);
+    return point(box.center(0), box.center(1), box.center(2));
+}
 
-        if(k == 0) {
-            if(Geometry_Object::check_intersection(*root_t, *p)) {
-                intersection_flags_[p_objects[0]->number()] = true;
-                intersection_flags_[cur_obj->number()] = true;
-            }
+template <typename T1, typename T2>
+void Intersection_Finder::on_intersection(const T1& obj1, const T2& obj2,
+                                          const Split_Planes& upper_planes)
+{
+    mark_intersection(obj1.number(), obj2.number());
+    if(!is_pairs_mode()) return;
+
+    //sides are computed like in partition, so crossing objects are the same
+    for(const Split_Plane& pl : upper_planes) {
+        if((object_side(pl, obj1) == 0) && (object_side(pl, obj2) == 0)) return;
+    }
+    const size_t num1 = obj1.number(), num2 = obj2.number();
+    settings_.on_pair(std::min(num1, num2), std::max(num1, num2));
+}
+
+void Intersection_Finder::compute_intersections_recursive_algorithm(
+        Objects_Indexes& indexes, Subset subset, Split_Planes& upper_planes, size_t depth)
+{
+    const size_t upper_planes_num = upper_planes.size();
+
+    //only one subset is processed recursively, the other one continues in this loop
+    size_t stalled_splits_num = 0;
+    while(subset.size() > 1) {
+        if(settings_.stats != nullptr) settings_.stats->add_split(depth, subset.size());
+
+        //splits which keep almost the whole subset take one root away at a time,
+        //a few of them in a row mean that planes of these objects don't separate them
+        const size_t size = subset.size();
+        subset = split_subset(indexes, subset, upper_planes, depth);
+        if(subset.size() > MAX_CHILD_PART * size) ++stalled_splits_num;
+        else stalled_splits_num = 0;
+
+        if((stalled_splits_num == MAX_STALLED_SPLITS) && (subset.size() > 1)) {
+            check_without_splits(indexes, subset, upper_planes);
+            break;
         }
     }
 
-    ++iter1;
+    //planes of this frame splits aren't above subsets of caller
+    upper_planes.erase(upper_planes.begin() + upper_planes_num, upper_planes.end());
+}
+
+Intersection_Finder::Subset Intersection_Finder::split_subset(
+        Objects_Indexes& indexes, Subset subset, Split_Planes& upper_planes, size_t depth)
+{
+    if((settings_.split == SAMPLED_SPLIT) && (subset.size() >= SAMPLED_SPLIT_MIN_SIZE)) {
+        std::optional<Split_Plane> axis_plane = choose_split(indexes, subset);
+
+        if(axis_plane.has_value()) {
+            Subset next_subset = axis_plane_case(indexes, subset, *axis_plane, upper_planes, depth);
 
-    if(p_objects_new1.size() == (p_objects.size() - 1)) {
-        ++iter2;
-        compute_intersections_recursive_algorithm(p_objects_new1);
+            //if every object crosses the plane, the root object is used instead
+            if(next_subset.size() < subset.size()) return next_subset;
+        }
     }
-    else if (p_objects_new2.size() == (p_objects.size() - 1)) {
-        ++iter3;
-        compute_intersections_recursive_algorithm(p_objects_new2);
+
+    //triangles are the best roots: their planes are given for free
+    if(subset.triangles.size() > 0) {
+        const Triangle_Record& root_t = objects_.triangles()[indexes.triangles[subset.triangles.begin]];
+        ++subset.triangles.begin;
+
+        return root_case(indexes, subset, root_t, split_plane(root_t, split_kind()),
+                         upper_planes, depth);
     }
-    else {
-        ++iter4;
-        compute_intersections_recursive_algorithm(p_objects_new1);
-        compute_intersections_recursive_algorithm(p_objects_new2);
+
+    if(subset.cuts.size() > 0) {
+        const Object_Cut& root_c = objects_.cuts()[indexes.cuts[subset.cuts.begin]];
+        ++subset.cuts.begin;
+
+        //any plane through the cut separates objects like triangle plane does
+        const Split_Plane pl = plane_through_cut(root_c, spread_axis(indexes, subset), split_kind());
+        return root_case(indexes, subset, root_c, pl, upper_planes, depth);
     }
+
+    const Object_Point& root_p = objects_.points()[indexes.points[subset.points.begin]];
+    ++subset.points.begin;
+
+    const int axis = spread_axis(indexes, subset);
+    const double coords[3] = {root_p.x(), root_p.y(), root_p.z()};
+    return root_case(indexes, subset, root_p, axis_aligned_plane(axis, coords[axis], split_kind()),
+                     upper_planes, depth);
 }
 
-void Intersection_Finder::root_cut_case(const std::vector<Geometry_Object*>& p_objects,
-                                        const Object_Cut* root_c) {
-    std::vector<Geometry_Object*> p_objects_new;
+void Intersection_Finder::check_without_splits(const Objects_Indexes& indexes, Subset subset,
+                                               const Split_Planes& upper_planes)
+{
+    if(settings_.stats != nullptr) settings_.stats->add_unsplit_subset(subset.size());
 
-    for(size_t i = 1; i < p_objects.size(); ++i) {
-        Geometry_Object* cur_obj = p_objects[i];
-        p_objects_new.push_back(cur_obj);
+    std::vector<Object_Ref> refs;
+    refs.reserve(subset.size());
+    for(size_t i = subset.triangles.begin; i < subset.triangles.end; ++i) {
+        refs.push_back(Object_Ref{TRIANGLE, indexes.triangles[i]});
+    }
+    for(size_t i = subset.cuts.begin; i < subset.cuts.end; ++i) {
+        refs.push_back(Object_Ref{CUT, indexes.cuts[i]});
+    }
+    for(size_t i = subset.points.begin; i < subset.points.end; ++i) {
+        refs.push_back(Object_Ref{POINT, indexes.points[i]});
+    }
 
-        if(typeid(*cur_obj) == typeid(Object_Triangle)) {
-            const Object_Triangle* t = static_cast<Object_Triangle*>(cur_obj);
+    std::vector<Bounding_Box> boxes = objects_boxes(refs);
 
-            if(Geometry_Object::check_intersection(*root_c, *t)) {
-                intersection_flags_[p_objects[0]->number()] = true;
-                intersection_flags_[cur_obj->number()] = true;
+    //tree isn't worth building for a few objects
+    if(refs.size() <= PAIRWISE_MAX_SIZE) {
+        for(size_t i = 0; i < refs.size(); ++i) {
+            for(size_t j = i + 1; j < refs.size(); ++j) {
+                if(is_boxes_intersects(boxes[i], boxes[j])) check_refs(refs[i], refs[j], upper_planes);
             }
+        }
+        return;
+    }
 
-            continue;
+    BVH_Tree tree(std::move(boxes));
+    tree.for_each_overlapping_pair([this, &refs, &upper_planes](size_t i, size_t j) {
+        check_refs(refs[i], refs[j], upper_planes);
+    }, pool_, settings_.sequential_cutoff);
+}
+
+template <typename Root>
+Intersection_Finder::Subset Intersection_Finder::root_case(
+        Objects_Indexes& indexes, Subset objs, const Root& root, const Split_Plane& pl,
+        Split_Planes& upper_planes, size_t depth)
+{
+    constexpr bool is_triangle_root = std::is_same<Root, Triangle_Record>::value;
+    std::vector<const Triangle_Record*>& crossing = crossing_triangles();
+    crossing.clear();
+
+    //objects crossing the root plane are the only ones which can touch the root,
+    //triangles are checked with triangle root later by packets
+    size_t skipped_tests_num = 0;
+    auto check_with_root = [&](const auto& cur_obj) {
+        using Obj = std::decay_t<decltype(cur_obj)>;
+        if constexpr(is_triangle_root && std::is_same<Obj, Triangle_Record>::value) {
+            crossing.push_back(&cur_obj);
         }
+        else if(is_pair_skipped(root.number(), cur_obj.number())) {
+            ++skipped_tests_num;
+        }
+        else {
+            if(check_objects(root, cur_obj)) on_intersection(root, cur_obj, upper_planes);
+        }
+    };
 
-        if(typeid(*cur_obj) == typeid(Object_Cut)) {
-            const Object_Cut* c = static_cast<Object_Cut*>(cur_obj);
+    Subset_Borders borders = partition_by_plane(indexes, objs, pl, check_with_root);
+    if constexpr(is_triangle_root) check_crossing_triangles(root, crossing, upper_planes);
 
-            if(Geometry_Object::check_intersection(*root_c, *c)) {
-                intersection_flags_[p_objects[0]->number()] = true;
-                intersection_flags_[cur_obj->number()] = true;
-            }
+    //counters are shared by threads, so they are updated once per root
+    if((settings_.stats != nullptr) && (skipped_tests_num > 0)) {
+        settings_.stats->add_skipped_calls(skipped_tests_num);
+    }
 
-            continue;
-        }
+    return process_subsets(indexes, objs, borders, pl, upper_planes, depth);
+}
 
-        assert(typeid(*cur_obj) == typeid(Object_Point));
-        const Object_Point* p = static_cast<Object_Point*>(cur_obj);
+void Intersection_Finder::check_crossing_triangles(
+        const Triangle_Record& root, std::vector<const Triangle_Record*>& crossing,
+        const Split_Planes& upper_planes)
+{
+    thread_local std::vector<const Triangle_Coords*> coords;
+    thread_local std::vector<uint8_t> results;
+    auto check_packet = [&](size_t begin, size_t end) {
+        coords.clear();
+        for(size_t k = begin; k < end; ++k) {
+            coords.push_back(&crossing[k]->coords());
+        }
+        results.resize(coords.size());
 
-        if(Geometry_Object::check_intersection(*root_c, *p)) {
-            intersection_flags_[p_objects[0]->number()] = true;
-            intersection_flags_[cur_obj->number()] = true;
+        if(settings_.stats != nullptr) {
+            settings_.stats->add_narrow_calls(TRIANGLE, TRIANGLE, coords.size());
+            for(const Triangle_Coords* t : coords) {
+                settings_.stats->add_plane_test(TRIANGLE, triangles_plane_test(root.coords(), *t));
+            }
+        }
+        Phase_Timer timer(settings_.stats, NARROW_PHASE);
+        if(settings_.predicates == EXACT_PREDICATES) {
+            for(size_t k = 0; k < coords.size(); ++k) {
+                results[k] = is_triangles_intersects_exact(root.coords().v, coords[k]->v);
+            }
+        }
+        else if(settings_.predicates == INTEGER_PREDICATES) {
+            for(size_t k = 0; k < coords.size(); ++k) {
+                results[k] = is_triangles_intersects_integer(root.coords(), *coords[k]);
+            }
+        }
+        else {
+            is_triangles_intersects_packet(root.coords(), triangle_cache(root),
+                                           coords.data(), coords.size(), results.data());
+        }
+        for(size_t k = begin; k < end; ++k) {
+            if(results[k - begin]) on_intersection(root, *crossing[k], upper_planes);
         }
+    };
+
+    if(settings_.flags_only == false) {
+        check_packet(0, crossing.size());
+        return;
+    }
+
+    //hit with flagged triangle can give only the flag of root,
+    //so unflagged triangles go first and they are always checked
+    auto is_unflagged = [this](const Triangle_Record* t) { return !is_flagged(t->number()); };
+    auto flagged_begin = std::partition(crossing.begin(), crossing.end(), is_unflagged);
+    const size_t unflagged_num = flagged_begin - crossing.begin();
+    check_packet(0, unflagged_num);
+
+    //flagged triangles are checked by small packets until root is flagged
+    size_t k = unflagged_num;
+    while((k < crossing.size()) && !is_flagged(root.number())) {
+        const size_t packet_end = std::min(k + FLAGGED_PACKET_SIZE, crossing.size());
+        check_packet(k, packet_end);
+        k = packet_end;
     }
 
-    compute_intersections_recursive_algorithm(p_objects_new);
+    if(settings_.stats != nullptr) settings_.stats->add_skipped_calls(crossing.size() - k);
 }
 
-void Intersection_Finder::root_point_case(const std::vector<Geometry_Object*>& p_objects,
-                                          const Object_Point* root_p) {
-    std::vector<Geometry_Object*> p_objects_new;
+template <typename F>
+Intersection_Finder::Subset_Borders Intersection_Finder::partition_by_plane(
+        Objects_Indexes& indexes, Subset objs, const Split_Plane& pl, F on_crossing)
+{
+    Subset_Borders borders;
+    std::tie(borders.triangles.lower_end, borders.triangles.upper_begin) =
+            partition_kind_by_plane(objects_.triangles(), indexes.triangles,
+                                         objs.triangles.begin, objs.triangles.end,
+                                         pl, on_crossing);
+    std::tie(borders.cuts.lower_end, borders.cuts.upper_begin) =
+            partition_kind_by_plane(objects_.cuts(), indexes.cuts,
+                                         objs.cuts.begin, objs.cuts.end,
+                                         pl, on_crossing);
+    std::tie(borders.points.lower_end, borders.points.upper_begin) =
+            partition_kind_by_plane(objects_.points(), indexes.points,
+                                         objs.points.begin, objs.points.end,
+                                         pl, on_crossing);
+    return borders;
+}
 
-    for(size_t i = 1; i < p_objects.size(); ++i) {
-        Geometry_Object* cur_obj = p_objects[i];
-        p_objects_new.push_back(cur_obj);
+int Intersection_Finder::spread_axis(const Objects_Indexes& indexes, Subset subset) const {
+    //axis of the biggest spread of objects centers, estimated by a few objects
+    const size_t SAMPLE_SIZE = 8;
+    const size_t step = std::max<size_t>(subset.size() / SAMPLE_SIZE, 1);
 
-        if(typeid(*cur_obj) == typeid(Object_Triangle)) {
-            const Object_Triangle* t = static_cast<Object_Triangle*>(cur_obj);
+    Bounding_Box centers_box;
+    for(size_t i = subset.triangles.begin; i < subset.triangles.end; i += step) {
+        centers_box.extend(box_center(objects_.triangles()[indexes.triangles[i]]));
+    }
+    for(size_t i = subset.cuts.begin; i < subset.cuts.end; i += step) {
+        centers_box.extend(box_center(objects_.cuts()[indexes.cuts[i]]));
+    }
+    for(size_t i = subset.points.begin; i < subset.points.end; i += step) {
+        centers_box.extend(box_center(objects_.points()[indexes.points[i]]));
+    }
+    return centers_box.largest_axis();
+}
 
-            if(Geometry_Object::check_intersection(*root_p, *t)) {
-                intersection_flags_[p_objects[0]->number()] = true;
-                intersection_flags_[cur_obj->number()] = true;
+std::optional<Split_Plane> Intersection_Finder::choose_split(Objects_Indexes& indexes,
+                                                       Subset subset) const
+{
+    //objects evenly spread over subset stand for the whole subset
+    const size_t sample_step = std::max<size_t>(subset.size() / SPLIT_SAMPLE_SIZE, 1);
+
+    //estimation of bigger subset size, subsets share crossing objects
+    auto score = [&](const Split_Plane& pl) {
+        size_t lower = 0, crossing = 0, upper = 0;
+        auto count = [&](const auto& storage, const std::vector<uint32_t>& kind_indexes,
+                         Objects_Range range) {
+            for(size_t i = range.begin; i < range.end; i += sample_step) {
+                int k = object_side(pl, storage[kind_indexes[i]]);
+                if(k == -1) ++lower;
+                else if(k == 1) ++upper;
+                else ++crossing;
             }
+        };
+        count(objects_.triangles(), indexes.triangles, subset.triangles);
+        count(objects_.cuts(), indexes.cuts, subset.cuts);
+        count(objects_.points(), indexes.points, subset.points);
+        return std::max(lower, upper) + crossing;
+    };
+
+    //triangle planes: root at subset.triangles.begin is the first candidate
+    size_t best_root = subset.triangles.begin;
+    size_t best_score = SIZE_MAX;
+    const size_t candidate_step = std::max<size_t>(
+                subset.triangles.size() / SPLIT_TRIANGLE_CANDIDATES, 1);
+    for(size_t i = subset.triangles.begin; i < subset.triangles.end; i += candidate_step) {
+        size_t cur_score = score(split_plane(objects_.triangles()[indexes.triangles[i]],
+                                             split_kind()));
+        if(cur_score < best_score) {
+            best_score = cur_score;
+            best_root = i;
+        }
+    }
+    if(subset.triangles.size() > 0) {
+        std::swap(indexes.triangles[subset.triangles.begin], indexes.triangles[best_root]);
+    }
 
-            continue;
+    //axis aligned planes through median of sample box centers
+    std::vector<point> centers;
+    centers.reserve(SPLIT_SAMPLE_SIZE + 3);
+    for(size_t i = subset.triangles.begin; i < subset.triangles.end; i += sample_step) {
+        centers.push_back(box_center(objects_.triangles()[indexes.triangles[i]]));
+    }
+    for(size_t i = subset.cuts.begin; i < subset.cuts.end; i += sample_step) {
+        centers.push_back(box_center(objects_.cuts()[indexes.cuts[i]]));
+    }
+    for(size_t i = subset.points.begin; i < subset.points.end; i += sample_step) {
+        centers.push_back(box_center(objects_.points()[indexes.points[i]]));
+    }
+
+    std::optional<Split_Plane> best_axis_plane;
+    std::vector<double> coords(centers.size());
+    for(int axis = 0; axis < 3; ++axis) {
+        for(size_t i = 0; i < centers.size(); ++i) {
+            coords[i] = (axis == 0) ? centers[i].x() : ((axis == 1) ? centers[i].y() : centers[i].z());
+        }
+        auto median = coords.begin() + coords.size() / 2;
+        std::nth_element(coords.begin(), median, coords.end());
+
+        Split_Plane pl = axis_aligned_plane(axis, *median, split_kind());
+        size_t cur_score = score(pl);
+        if(cur_score < best_score) {
+            best_score = cur_score;
+            best_axis_plane = pl;
         }
+    }
 
-        if(typeid(*cur_obj) == typeid(Object_Cut)) {
-            const Object_Cut* c = static_cast<Object_Cut*>(cur_obj);
+    return best_axis_plane;
+}
 
-            if(Geometry_Object::check_intersection(*root_p, *c)) {
-                intersection_flags_[p_objects[0]->number()] = true;
-                intersection_flags_[cur_obj->number()] = true;
-            }
+Intersection_Finder::Subset Intersection_Finder::axis_plane_case(
+        Objects_Indexes& indexes, Subset subset, const Split_Plane& pl, Split_Planes& upper_planes,
+        size_t depth)
+{
+    Subset_Borders borders = partition_by_plane(indexes, subset, pl, [](const auto&) {});
 
-            continue;
-        }
+    Subset lower = borders.lower(subset);
+    Subset upper = borders.upper(subset);
+    if((lower.size() == subset.size()) && (upper.size() == subset.size())) {
+        return subset;
+    }
 
-        assert(typeid(*cur_obj) == typeid(Object_Point));
-        const Object_Point* p = static_cast<Object_Point*>(cur_obj);
+    return process_subsets(indexes, subset, borders, pl, upper_planes, depth);
+}
 
-        if(Geometry_Object::check_intersection(*root_p, *p)) {
-            intersection_flags_[p_objects[0]->number()] = true;
-            intersection_flags_[cur_obj->number()] = true;
-        }
+Intersection_Finder::Subset Intersection_Finder::process_subsets(
+        Objects_Indexes& indexes, Subset objs, Subset_Borders borders, const Split_Plane& pl,
+        Split_Planes& upper_planes, size_t depth)
+{
+    Subset lower = borders.lower(objs);
+    Subset upper = borders.upper(objs);
+
+    //crossing objects are in both subsets: if there are many of them,
+    //every split multiplies work, so objects are checked without splits
+    if(lower.size() + upper.size() > (1 + MAX_CROSSING_PART) * objs.size()) {
+        check_without_splits(indexes, objs, upper_planes);
+        return Subset{};
+    }
+
+    if(upper.size() == objs.size()) {
+        return upper;
+    }
+    if(lower.size() == objs.size()) {
+        return lower;
     }
 
-    compute_intersections_recursive_algorithm(p_objects_new);
+    //smaller subset is processed first, so recursion depth is logarithmic
+    const bool is_lower_first = (lower.size() <= upper.size());
+    const Subset first = is_lower_first ? lower : upper;
+    const Subset second = is_lower_first ? upper : lower;
+
+    if((pool_ != nullptr) && (first.size() >= settings_.sequential_cutoff)) {
+        //subsets overlap by crossing objects, so other thread gets its own copy
+        auto copy_range = [](const std::vector<uint32_t>& kind_indexes, Objects_Range range) {
+            return std::vector<uint32_t>(kind_indexes.begin() + range.begin,
+                                         kind_indexes.begin() + range.end);
+        };
+        Objects_Indexes first_copy{copy_range(indexes.triangles, first.triangles),
+                                   copy_range(indexes.cuts, first.cuts),
+                                   copy_range(indexes.points, first.points)};
+
+        Split_Planes first_planes = upper_planes;
+        if(is_pairs_mode() && !is_lower_first) first_planes.push_back(pl);
+
+        pool_->submit(tasks_, [this, depth, first_copy = std::move(first_copy),
+                               first_planes = std::move(first_planes)]() mutable {
+            Subset all{Objects_Range{0, first_copy.triangles.size()},
+                       Objects_Range{0, first_copy.cuts.size()},
+                       Objects_Range{0, first_copy.points.size()}};
+            compute_intersections_recursive_algorithm(first_copy, all, first_planes, depth + 1);
+        });
+        if(is_pairs_mode() && is_lower_first) upper_planes.push_back(pl);
+        return second;
+    }
+
+    if(is_pairs_mode() && !is_lower_first) upper_planes.push_back(pl);
+    compute_intersections_recursive_algorithm(indexes, first, upper_planes, depth + 1);
+    if(is_pairs_mode() && !is_lower_first) upper_planes.pop_back();
+
+    //first subset was reordered: its crossing objects are gathered back
+    //to the border with the second subset by one more partition
+    const int first_side = is_lower_first ? -1 : 0;
+    size_t border;
+    border = gather_side(objects_.triangles(), indexes.triangles,
+                         first.triangles.begin, first.triangles.end, pl, first_side);
+    assert(border == (is_lower_first ? borders.triangles.lower_end : borders.triangles.upper_begin));
+    border = gather_side(objects_.cuts(), indexes.cuts,
+                         first.cuts.begin, first.cuts.end, pl, first_side);
+    assert(border == (is_lower_first ? borders.cuts.lower_end : borders.cuts.upper_begin));
+    border = gather_side(objects_.points(), indexes.points,
+                         first.points.begin, first.points.end, pl, first_side);
+    assert(border == (is_lower_first ? borders.points.lower_end : borders.points.upper_begin));
+    (void) border;
+
+    if(is_pairs_mode() && is_lower_first) upper_planes.push_back(pl);
+    return second;
+}
+
+template <typename F>
+auto Intersection_Finder::visit_object(Object_Ref ref, F func) const {
+    if(ref.type == TRIANGLE) return func(objects_.triangles()[ref.index]);
+    if(ref.type == CUT) return func(objects_.cuts()[ref.index]);
+    assert(ref.type == POINT);
+    return func(objects_.points()[ref.index]);
+}
+
+void Intersection_Finder::check_refs(Object_Ref ref1, Object_Ref ref2,
+                                     const Split_Planes& upper_planes)
+{
+    visit_object(ref1, [this, ref2, &upper_planes](const auto& obj1) {
+        visit_object(ref2, [this, &obj1, &upper_planes](const auto& obj2) {
+            if(is_pair_skipped(obj1.number(), obj2.number())) {
+                if(settings_.stats != nullptr) settings_.stats->add_skipped_calls(1);
+                return;
+            }
+            if(check_objects(obj1, obj2)) on_intersection(obj1, obj2, upper_planes);
+        });
+    });
+}
+
+std::vector<Bounding_Box> Intersection_Finder::objects_boxes(
+        const std::vector<Object_Ref>& refs) const
+{
+    std::vector<Bounding_Box> boxes;
+    boxes.reserve(refs.size());
+    for(Object_Ref ref : refs) {
+        boxes.push_back(visit_object(ref, [this](const auto& obj) { return object_box(obj); }));
+    }
+    return boxes;
+}
+
+void Intersection_Finder::bvh_algorithm(const std::vector<Object_Ref>& refs) {
+    BVH_Tree tree(objects_boxes(refs));
+
+    //narrow phase only for objects with intersecting boxes
+    const Split_Planes no_planes;
+    tree.for_each_overlapping_pair([this, &refs, &no_planes](size_t i, size_t j) {
+        check_refs(refs[i], refs[j], no_planes);
+    }, pool_, settings_.sequential_cutoff);
+}
+
+void Intersection_Finder::grid_algorithm(const std::vector<Object_Ref>& refs) {
+    Uniform_Grid grid(objects_boxes(refs));
+
+    //grid reports every pair once even if objects share several cells
+    const Split_Planes no_planes;
+    grid.for_each_overlapping_pair([this, &refs, &no_planes](size_t i, size_t j) {
+        check_refs(refs[i], refs[j], no_planes);
+    }, pool_, settings_.sequential_cutoff);
 }
 
 
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 #include <stdexcept>
 
 #include "geometry.h"
+#include "thread_pool.h"
+#include "triangle_record.h"
+#include "tri_tri_kernel.h"
+#include "pair_output.h"
+#include "finder_stats.h"
+#include "plane_classifier.h"
 
 namespace geometry {
 
@@ -20,6 +31,8 @@ public:
     virtual ~Geometry_Object() {}
 
     static bool check_intersection(const Triangle &t, const Triangle &t1);
+    //the first way through Cut and 2d objects, bench checks kernels against it
+    static bool check_intersection_reference(const Triangle &t1, const Triangle &t2);
     static bool check_intersection(const Triangle &t, const Cut &c);
     static bool check_intersection(const Cut &c, const Triangle &t) {
         return check_intersection(t, c);
@@ -52,14 +65,6 @@ public:
         Geometry_Object(num), Cut(c){}
 };
 
-class Object_Triangle final :
-        public Geometry_Object,
-        public Triangle {
-public:
-    Object_Triangle(const Triangle& t, size_t num):
-        Geometry_Object(num), Triangle(t) {}
-};
-
 class Undefined_Object final {
 private:
     point p1_;
@@ -83,18 +88,27 @@ class Geometry_Object_Storage final {
 private:
     std::vector<Object_Point> obj_point_storage_;
     std::vector<Object_Cut> obj_cut_storage_;
-    std::vector<Object_Triangle> obj_triangle_storage_;
+    std::vector<Triangle_Record> obj_triangle_storage_;
+    //triangle_caches()[i] is for triangles()[i], it's filled once with storage
+    std::vector<Triangle_Cache> obj_triangle_cache_;
 public:
     std::vector<Object_Point>& points() { return obj_point_storage_; }
     std::vector<Object_Cut>& cuts() { return obj_cut_storage_; }
-    std::vector<Object_Triangle>& triangles() { return obj_triangle_storage_; }
+    std::vector<Triangle_Record>& triangles() { return obj_triangle_storage_; }
 
     const std::vector<Object_Point>& points() const { return obj_point_storage_; }
     const std::vector<Object_Cut>& cuts() const { return obj_cut_storage_; }
-    const std::vector<Object_Triangle>& triangles() const { return obj_triangle_storage_; }
+    const std::vector<Triangle_Record>& triangles() const { return obj_triangle_storage_; }
+    const std::vector<Triangle_Cache>& triangle_caches() const { return obj_triangle_cache_; }
 
     Geometry_Object_Storage(const std::vector<Undefined_Object>& undef_objects);
 
+    //kind of object is chosen by its points (point, cut or triangle),
+    //returns kind and index of the new object in storage of its kind
+    std::pair<g_obj_type, size_t> add(const Undefined_Object& obj, size_t number);
+    //the last object of this kind takes place of the removed one
+    void remove(g_obj_type type, size_t index);
+
     size_t capacity() const { return obj_point_storage_.size() +
                                      obj_cut_storage_.size() +
                                      obj_triangle_storage_.size(); }
@@ -125,7 +139,7 @@ public:
     size_t points_num() const { return objects_.points().size(); }
     size_t objects_num() const { return objects_.capacity(); }
 
-    const std::vector<Object_Triangle>& triangles() const {
+    const std::vector<Triangle_Record>& triangles() const {
         return objects_.triangles();
     }
     const std::vector<Object_Cut>& cuts() const {
@@ -144,24 +158,202 @@ public:
     }
 };
 
+enum finder_engine {PLANE_SPLIT_ENGINE, BVH_ENGINE, GRID_ENGINE};
+//FIRST_OBJECT_SPLIT - first object of subset is always the root,
+//SAMPLED_SPLIT - the most balanced of sampled triangle and axis aligned planes
+enum split_strategy {FIRST_OBJECT_SPLIT, SAMPLED_SPLIT};
+//TOLERANCE_PREDICATES - objects closer than DOUBLE_GAP intersect,
+//EXACT_PREDICATES - objects intersect only if they have a common point,
+//signs are computed by exact_predicates.h, so they are right at any coordinates scale,
+//INTEGER_PREDICATES - the same checks for objects on integer grid (see fixed_decimal.h),
+//their signs are computed in int64 and int128 arithmetic without filters
+enum predicate_kind {TOLERANCE_PREDICATES, EXACT_PREDICATES, INTEGER_PREDICATES};
+//scalar of triangle copies which are classified by split planes of PLANE_SPLIT_ENGINE,
+//FLOAT_SCALAR has twice as many vector lanes, but its copies are kept beside records,
+//its tolerance grows with coordinates (see Scalar_Triangles) and objects are
+//checked with each other in double anyway, so results are the same
+enum scalar_kind {DOUBLE_SCALAR, FLOAT_SCALAR};
+
+struct Finder_Settings {
+    finder_engine engine = PLANE_SPLIT_ENGINE;
+    split_strategy split = SAMPLED_SPLIT;
+    //narrow phase and sides of split planes (kinds of objects are chosen with tolerance anyway)
+    predicate_kind predicates = TOLERANCE_PREDICATES;
+    scalar_kind scalar = DOUBLE_SCALAR;  //it's ignored with exact predicates
+    bool recentre = true;                //float copies are relative to center of triangles
+    size_t threads_num = 1;          //0 means all hardware threads
+    size_t sequential_cutoff = 512;  //smaller subsets are never given to other threads
+    //only flags are computed: pairs of objects which are both flagged already
+    //aren't checked, because their result can't change the output
+    bool flags_only = true;
+    //if it's set, every intersecting pair is given to it once, smaller number first,
+    //and flags_only is ignored
+    Intersection_Callback on_pair;
+    //if it's set, statistics of search are added to it, it must live until search ends
+    Finder_Stats* stats = nullptr;
+};
+
 class Intersection_Finder final {
 private:
     size_t num_of_objects_;
     Geometry_Object_Storage objects_;
-    std::vector <bool> intersection_flags_;
-    size_t iter1 = 0, iter2 = 0, iter3 = 0, iter4 = 0;
-
-    //this methods for computing intersections algorithm
-    void compute_intersections_recursive_algorithm(
-            const std::vector<Geometry_Object*>& p_objects);
-    void root_triangle_case(const std::vector<Geometry_Object*>& p_objects,
-                            const Object_Triangle* root_t);
-    void root_cut_case(const std::vector<Geometry_Object*>& p_objects,
-                            const Object_Cut* root_c);
-    void root_point_case(const std::vector<Geometry_Object*>& p_objects,
-                            const Object_Point* root_p);
+    Finder_Settings settings_;
+    //atomic because subsets are processed concurrently in parallel mode
+    std::vector<std::atomic<bool>> intersection_flags_;
+    Work_Stealing_Pool* pool_ = nullptr;
+    std::unique_ptr<Scalar_Triangles<float>> float_triangles_; //only in float mode
+    Task_Group tasks_; //subsets given to other threads
+
+    void mark_intersection(size_t num1, size_t num2) {
+        intersection_flags_[num1].store(true, std::memory_order_relaxed);
+        intersection_flags_[num2].store(true, std::memory_order_relaxed);
+    }
+    bool is_flagged(size_t num) const {
+        return intersection_flags_[num].load(std::memory_order_relaxed);
+    }
+    bool is_pair_skipped(size_t num1, size_t num2) const {
+        return settings_.flags_only && is_flagged(num1) && is_flagged(num2);
+    }
+    bool is_pairs_mode() const { return static_cast<bool>(settings_.on_pair); }
+    //split planes don't go through grid points, so their sides are exact in doubles
+    bool is_exact_mode() const { return settings_.predicates != TOLERANCE_PREDICATES; }
+    Split_Kind split_kind() const { return Split_Kind{is_exact_mode(), float_triangles_.get()}; }
+
+    struct Objects_Range {
+        size_t begin;
+        size_t end;
+        size_t size() const { return end - begin; }
+    };
+
+    //objects of every kind are kept apart, so their type is known in every loop:
+    //subset consists of ranges of numbers in triangles, cuts and points storages
+    struct Objects_Indexes {
+        std::vector<uint32_t> triangles;
+        std::vector<uint32_t> cuts;
+        std::vector<uint32_t> points;
+    };
+
+    struct Subset {
+        Objects_Range triangles;
+        Objects_Range cuts;
+        Objects_Range points;
+        size_t size() const { return triangles.size() + cuts.size() + points.size(); }
+    };
+
+    struct Split_Borders {
+        size_t lower_end;
+        size_t upper_begin;
+    };
+
+    struct Subset_Borders {
+        Split_Borders triangles;
+        Split_Borders cuts;
+        Split_Borders points;
+
+        Subset lower(Subset objs) const {
+            return Subset{Objects_Range{objs.triangles.begin, triangles.upper_begin},
+                          Objects_Range{objs.cuts.begin, cuts.upper_begin},
+                          Objects_Range{objs.points.begin, points.upper_begin}};
+        }
+        Subset upper(Subset objs) const {
+            return Subset{Objects_Range{triangles.lower_end, objs.triangles.end},
+                          Objects_Range{cuts.lower_end, objs.cuts.end},
+                          Objects_Range{points.lower_end, objs.points.end}};
+        }
+    };
+
+    //narrow phase: triangles are checked with their caches from storage,
+    //every record lives in storage, so its position gives its cache
+    const Triangle_Cache& triangle_cache(const Triangle_Record& t) const {
+        return objects_.triangle_caches()[&t - objects_.triangles().data()];
+    }
+    Cached_Triangle narrow_shape(const Triangle_Record& t) const {
+        return Cached_Triangle{t.coords(), triangle_cache(t)};
+    }
+    static const Cut& narrow_shape(const Object_Cut& c) { return c; }
+    static const point& narrow_shape(const Object_Point& p) { return p; }
+    template <typename T1, typename T2>
+    bool check_objects(const T1& obj1, const T2& obj2) const;
+    template <typename T>
+    Bounding_Box object_box(const T& obj) const;
+    template <typename T>
+    point box_center(const T& obj) const;
+
+    static const size_t SAMPLED_SPLIT_MIN_SIZE = 512;
+    //progress of splits is measured for subsets of every size: split is stalled if
+    //the next subset keeps more than MAX_CHILD_PART of objects, subset is checked
+    //without splits after MAX_STALLED_SPLITS stalls in a row or a split where
+    //more than MAX_CROSSING_PART of objects cross the plane
+    static constexpr double MAX_CHILD_PART = 0.9;
+    static constexpr double MAX_CROSSING_PART = 0.25;
+    static const size_t MAX_STALLED_SPLITS = 8;
+    static const size_t PAIRWISE_MAX_SIZE = 16;
+    static const size_t SPLIT_SAMPLE_SIZE = 32;
+    static const size_t SPLIT_TRIANGLE_CANDIDATES = 5;
+    static const size_t FLAGGED_PACKET_SIZE = 8;
+
+    //objects crossing a split plane are in both subsets, so pair of such objects
+    //is reported in the lower subset only: every subset keeps planes of splits
+    //where it's the upper subset (they are kept only in pairs mode)
+    using Split_Planes = std::vector<Split_Plane>;
+    //sides are computed like in partition, float copies of triangles are found by records
+    template <typename T>
+    int object_side(const Split_Plane& pl, const T& obj) const;
+    template <typename T1, typename T2>
+    void on_intersection(const T1& obj1, const T2& obj2, const Split_Planes& upper_planes);
+
+    //this methods for computing intersections algorithm,
+    //objects are partitioned in place inside index arrays of every kind,
+    //root case returns subset of objects which remain to be checked
+    //depth is number of recursive calls above, it's needed only for stats
+    void compute_intersections_recursive_algorithm(Objects_Indexes& indexes, Subset subset,
+                                                   Split_Planes& upper_planes, size_t depth);
+    //one split by sampled plane or by root, returns subset which remains to be checked
+    Subset split_subset(Objects_Indexes& indexes, Subset subset, Split_Planes& upper_planes,
+                        size_t depth);
+    //subset which planes can't split is checked by BVH, small one by all pairs
+    void check_without_splits(const Objects_Indexes& indexes, Subset subset,
+                              const Split_Planes& upper_planes);
+    template <typename Root>
+    Subset root_case(Objects_Indexes& indexes, Subset objs, const Root& root, const Split_Plane& pl,
+                     Split_Planes& upper_planes, size_t depth);
+    int spread_axis(const Objects_Indexes& indexes, Subset subset) const;
+    //unflagged triangles are checked first, flagged ones are skipped once root is flagged
+    void check_crossing_triangles(const Triangle_Record& root,
+                                  std::vector<const Triangle_Record*>& crossing,
+                                  const Split_Planes& upper_planes);
+
+    //moves the best sampled triangle to subset.triangles.begin,
+    //returns axis aligned plane if it splits sample better than any triangle
+    std::optional<Split_Plane> choose_split(Objects_Indexes& indexes, Subset subset) const;
+    Subset axis_plane_case(Objects_Indexes& indexes, Subset subset, const Split_Plane& pl,
+                           Split_Planes& upper_planes, size_t depth);
+    //on_crossing is called for every object crossing the plane
+    template <typename F>
+    Subset_Borders partition_by_plane(Objects_Indexes& indexes, Subset objs,
+                                      const Split_Plane& pl, F on_crossing);
+    //second subset is returned, if it's the upper one, pl is added to upper_planes
+    Subset process_subsets(Objects_Indexes& indexes, Subset objs, Subset_Borders borders,
+                           const Split_Plane& pl, Split_Planes& upper_planes, size_t depth);
+
+    //engines with separated broad phase,
+    //objects of all kinds are numbered in one array of references
+    struct Object_Ref {
+        g_obj_type type;
+        uint32_t index; //in storage of its type
+    };
+
+    template <typename F>
+    auto visit_object(Object_Ref ref, F func) const;
+    void check_refs(Object_Ref ref1, Object_Ref ref2, const Split_Planes& upper_planes);
+    std::vector<Bounding_Box> objects_boxes(const std::vector<Object_Ref>& refs) const;
+    void bvh_algorithm(const std::vector<Object_Ref>& refs);
+    void grid_algorithm(const std::vector<Object_Ref>& refs);
+    //search by the engine of settings, tasks given to pool_ may still run after it
+    void search();
 public:
-    Intersection_Finder(Geometry_Object_Storage objects);
+    Intersection_Finder(Geometry_Object_Storage objects,
+                        Finder_Settings settings = Finder_Settings());
 
     Objects_and_Intersections compute_intersections();
 };
@@ -1,55 +1,168 @@
 #include <iostream>
+#include <fstream>
 #include <list>
 #include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "geometry.h"
 #include "intersection_finder.h"
+#include "finder_stats.h"
+#include "fixed_decimal.h"
+#include "result_output.h"
+#include "scene_file.h"
+#include "text_scene.h"
 #include "vulkan_drawing.h"
 //#include "triangles_generator.h"
 
 using namespace geometry;
 
-Undefined_Object input_geometry_object() {
-    double x, y, z;
-    std::cin >> x >> y >> z;
-    point p1(x, y, z);
-    std::cin >> x >> y >> z;
-    point p2(x, y, z);
-    std::cin >> x >> y >> z;
-    point p3(x, y, z);
-    return Undefined_Object(p1, p2, p3);
-}
+namespace {
 
-int main() {
-    size_t n;
-    std::cin >> n;
+int run(int argc, char** argv) {
+    //"--stats file" writes statistics of the run to file as JSON,
+    //"--exact" checks objects by exact predicates instead of DOUBLE_GAP tolerance,
+    //"--float" splits triangles by their float copies (see Finder_Settings::scalar),
+    //"--decimals N" or "--decimals auto" puts input with N digits after decimal point
+    //on integer grid and checks objects by INTEGER_PREDICATES (see fixed_decimal.h),
+    //"--scene file" reads binary scene (see scene_file.h) instead of text from stdin,
+    //"--input file" maps text file instead of reading stdin (see text_scene.h),
+    //"--format text|rle|bitset|json" and "--output file" choose how and where results
+    //are written (see result_output.h), "--pairs" writes intersecting pairs instead of objects
+    std::unique_ptr<Finder_Stats> stats;
+    std::string stats_file;
+    bool is_exact = false;
+    bool is_float = false;
+    std::string decimals;
+    std::string scene_file;
+    std::string input_file;
+    result_format format = TEXT_RESULT;
+    std::string output_file;
+    bool is_pairs = false;
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if((arg == "--stats") && (i + 1 < argc)) {
+            stats = std::make_unique<Finder_Stats>();
+            stats_file = argv[++i];
+        }
+        else if(arg == "--exact") is_exact = true;
+        else if(arg == "--float") is_float = true;
+        else if((arg == "--decimals") && (i + 1 < argc)) decimals = argv[++i];
+        else if((arg == "--scene") && (i + 1 < argc)) scene_file = argv[++i];
+        else if((arg == "--input") && (i + 1 < argc)) input_file = argv[++i];
+        else if((arg == "--format") && (i + 1 < argc)) format = parse_result_format(argv[++i]);
+        else if((arg == "--output") && (i + 1 < argc)) output_file = argv[++i];
+        else if(arg == "--pairs") is_pairs = true;
+    }
+    if(is_pairs && (format == RLE_RESULT)) throw std::invalid_argument("pairs have no rle format");
 
-    std::vector<Undefined_Object> objects;
-    objects.reserve(n);
+    //messages go to stderr unless results are plain text on stdout,
+    //bitsets need --output file because stdout of Windows changes line ends
+    std::ofstream result_file;
+    if(!output_file.empty()) {
+        result_file.open(output_file, std::ios::binary);
+        if(!result_file) throw std::invalid_argument("can't open " + output_file);
+    }
+    std::ostream& result_out = output_file.empty() ? std::cout : result_file;
+    const bool is_plain = output_file.empty() && (format == TEXT_RESULT);
+    std::ostream& log = is_plain ? std::cout : std::cerr;
 
-    for(size_t i = 0; i < n; i++) {
-        objects.push_back(input_geometry_object());
+    //objects of binary scene are added to storage right from the mapping,
+    //they are copied only to be put on grid
+    std::unique_ptr<Mapped_Scene> scene;
+    std::vector<Undefined_Object> objects;
+    {
+        Phase_Timer timer(stats.get(), PARSE_PHASE);
+        if(!scene_file.empty()) {
+            scene = std::make_unique<Mapped_Scene>(scene_file);
+            if(!decimals.empty()) {
+                objects.reserve(scene->objects_num());
+                for(size_t i = 0; i < scene->objects_num(); ++i) objects.push_back(scene->object(i));
+            }
+        }
+        else if(!input_file.empty()) objects = read_text_scene(input_file);
+        else objects = read_text_scene(std::cin);
     }
 
-    std::cout << "Input complete.\n";
+    log << "Input complete.\n";
 
-    Intersection_Finder intersection_finder{Geometry_Object_Storage(objects)};
-    Objects_and_Intersections intersection_defined_objects = intersection_finder.compute_intersections();
-    const std::vector<bool>& intersection_flags = intersection_defined_objects.intersection_flags();
+    Finder_Settings settings;
+    settings.threads_num = 0; //all hardware threads
+    settings.stats = stats.get();
+    if(is_exact) settings.predicates = EXACT_PREDICATES;
+    if(is_float) settings.scalar = FLOAT_SCALAR;
+    Pair_Buffers pairs;
+    if(is_pairs) settings.on_pair = pairs.callback();
 
-    std::cout << "Intersected objects:" << std::endl;
-    for(size_t i = 0; i < intersection_flags.size(); ++i) {
-        if(intersection_flags[i] == true) {
-            std::cout << i << std::endl;
+    //objects on grid are scaled, so input objects are drawn
+    std::vector<Undefined_Object> grid_objects;
+    if(!decimals.empty()) {
+        const int digits = (decimals == "auto") ? detect_decimal_digits(objects) : std::stoi(decimals);
+        if(digits >= 0) {
+            grid_objects = to_decimal_grid(objects, digits);
+            settings.predicates = INTEGER_PREDICATES;
         }
+        else {
+            std::cerr << "input has no fixed decimal digits, exact predicates are used\n";
+            settings.predicates = EXACT_PREDICATES;
+        }
+    }
+    const bool is_on_grid = (settings.predicates == INTEGER_PREDICATES);
+
+    auto input_storage = [&]() {
+        if(is_on_grid) return Geometry_Object_Storage(grid_objects);
+        if(objects.empty() && (scene != nullptr)) return make_storage(*scene);
+        return Geometry_Object_Storage(objects);
+    };
+
+    std::unique_ptr<Intersection_Finder> intersection_finder;
+    {
+        Phase_Timer timer(stats.get(), STORAGE_PHASE);
+        intersection_finder = std::make_unique<Intersection_Finder>(input_storage(), settings);
+    }
+    Objects_and_Intersections intersection_defined_objects = intersection_finder->compute_intersections();
+
+    if(stats != nullptr) {
+        std::ofstream stats_out(stats_file);
+        stats->write_json(stats_out);
     }
-    std::cout << std::endl;
+    const std::vector<bool>& intersection_flags = intersection_defined_objects.intersection_flags();
+
+    //objects of scene with ids are given by them
+    const uint64_t* ids = (scene != nullptr) ? scene->ids() : nullptr;
+    if(is_plain) std::cout << (is_pairs ? "Intersecting pairs:\n" : "Intersected objects:\n");
+    if(is_pairs) write_pairs(result_out, pairs, format, ids);
+    else write_flags(result_out, intersection_flags, format, ids);
+    if(is_plain) result_out << '\n';
+    //stream buffer can fail only here, after writers checked it
+    if(!result_out.flush()) throw std::runtime_error("results writing failed");
 
+    if(is_on_grid) {
+        intersection_defined_objects = Objects_and_Intersections(Geometry_Object_Storage(objects),
+                                                                 intersection_flags);
+    }
     draw_triangles_driver(std::move(intersection_defined_objects));
     return 0;
 }
 
+} //namespace
+
+//bad input and failed writing end the program with a message instead of abort
+int main(int argc, char** argv) {
+    try {
+        return run(argc, argv);
+    }
+    catch(const std::invalid_argument& e) {
+        std::cerr << e.what() << "\n";
+    }
+    catch(const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+    }
+    return 1;
+}
+
 /*
 int main() {
     Triangles_Generator tr{};
@@ -0,0 +1,73 @@
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+namespace geometry {
+
+//--------------------------------------Mapped_File--------------------------------
+
+Mapped_File::Mapped_File(const std::string& file_name) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) throw std::invalid_argument("can't open " + file_name);
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        throw std::invalid_argument("can't open " + file_name);
+    }
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if(size_ == 0) {
+        CloseHandle(file);
+        return;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(mapping == nullptr) throw std::invalid_argument("can't map " + file_name);
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(data == nullptr) {
+        CloseHandle(mapping);
+        throw std::invalid_argument("can't map " + file_name);
+    }
+    mapping_ = mapping;
+#else
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    if(fd < 0) throw std::invalid_argument("can't open " + file_name);
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::invalid_argument("can't open " + file_name);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if(size_ == 0) {
+        close(fd);
+        return;
+    }
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) throw std::invalid_argument("can't map " + file_name);
+#endif
+    data_ = static_cast<const char*>(data);
+}
+
+Mapped_File::~Mapped_File() {
+    if(data_ == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+#else
+    munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+} //namespace geometry
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+namespace geometry {
+
+//--------------------------------------Mapped_File--------------------------------
+
+//Whole file mapped to memory for reading (mmap or file mapping on Windows).
+//Empty file has no mapping, its data() is nullptr.
+//Constructor throws std::invalid_argument if file can't be opened or mapped.
+class Mapped_File final {
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    void* mapping_ = nullptr;  //handle of file mapping on Windows
+public:
+    explicit Mapped_File(const std::string& file_name);
+    ~Mapped_File();
+    Mapped_File(const Mapped_File&) = delete;
+    Mapped_File& operator=(const Mapped_File&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+} //namespace geometry
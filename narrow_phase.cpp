@@ -0,0 +1,184 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include "narrow_phase.h"
+#include "exact_kernel.h"
+#include "fixed_decimal.h"
+
+namespace geometry {
+
+//--------------------------------------Narrow_Phase-------------------------------
+
+namespace {
+
+//grid coordinates are integers, so they are exact in doubles
+template <typename Coord>
+void cut_ends(const Cut& c, Coord begin[3], Coord end[3]) {
+    const point p_end = c.p_end();
+    begin[0] = static_cast<Coord>(c.p_begin().x());
+    begin[1] = static_cast<Coord>(c.p_begin().y());
+    begin[2] = static_cast<Coord>(c.p_begin().z());
+    end[0] = static_cast<Coord>(p_end.x());
+    end[1] = static_cast<Coord>(p_end.y());
+    end[2] = static_cast<Coord>(p_end.z());
+}
+
+template <typename Coord>
+void point_coords(const point& p, Coord coords[3]) {
+    coords[0] = static_cast<Coord>(p.x());
+    coords[1] = static_cast<Coord>(p.y());
+    coords[2] = static_cast<Coord>(p.z());
+}
+
+} //namespace
+
+bool check_pair(const Cached_Triangle& t1, const Cached_Triangle& t2) {
+    return is_triangles_intersects(t1.coords, t1.cache, t2.coords);
+}
+
+bool check_pair(const Cached_Triangle& t, const Cut& c) {
+    double begin[3], end[3];
+    cut_ends(c, begin, end);
+    return is_triangle_and_cut_intersects(t.coords, t.cache, begin, end);
+}
+
+bool check_pair(const Cached_Triangle& t, const point& p) {
+    const double coords[3] = {p.x(), p.y(), p.z()};
+    return is_triangle_and_point_intersects(t.coords, t.cache, coords);
+}
+
+bool check_pair_exact(const Cached_Triangle& t1, const Cached_Triangle& t2) {
+    return is_triangles_intersects_exact(t1.coords.v, t2.coords.v);
+}
+
+bool check_pair_exact(const Cached_Triangle& t, const Cut& c) {
+    double begin[3], end[3];
+    cut_ends(c, begin, end);
+    return is_triangle_and_cut_intersects_exact(t.coords.v, begin, end);
+}
+
+bool check_pair_exact(const Cached_Triangle& t, const point& p) {
+    double coords[3];
+    point_coords(p, coords);
+    return is_triangle_and_point_intersects_exact(t.coords.v, coords);
+}
+
+bool check_pair_exact(const Cut& c1, const Cut& c2) {
+    double begin1[3], end1[3], begin2[3], end2[3];
+    cut_ends(c1, begin1, end1);
+    cut_ends(c2, begin2, end2);
+    return is_cuts_intersects_exact(begin1, end1, begin2, end2);
+}
+
+bool check_pair_exact(const Cut& c, const point& p) {
+    double begin[3], end[3], coords[3];
+    cut_ends(c, begin, end);
+    point_coords(p, coords);
+    return is_cut_and_point_intersects_exact(begin, end, coords);
+}
+
+bool check_pair_exact(const point& p1, const point& p2) {
+    double coords1[3], coords2[3];
+    point_coords(p1, coords1);
+    point_coords(p2, coords2);
+    return is_points_match_exact(coords1, coords2);
+}
+
+bool is_triangles_intersects_integer(const Triangle_Coords& t1, const Triangle_Coords& t2) {
+    int32_t grid1[3][3], grid2[3][3];
+    for(int vertex = 0; vertex < 3; ++vertex) {
+        grid_coords(t1.v[vertex], grid1[vertex]);
+        grid_coords(t2.v[vertex], grid2[vertex]);
+    }
+    return is_triangles_intersects_exact(grid1, grid2);
+}
+
+bool check_pair_integer(const Cached_Triangle& t1, const Cached_Triangle& t2) {
+    return is_triangles_intersects_integer(t1.coords, t2.coords);
+}
+
+bool check_pair_integer(const Cached_Triangle& t, const Cut& c) {
+    int32_t grid[3][3], begin[3], end[3];
+    for(int vertex = 0; vertex < 3; ++vertex) grid_coords(t.coords.v[vertex], grid[vertex]);
+    cut_ends(c, begin, end);
+    return is_triangle_and_cut_intersects_exact(grid, begin, end);
+}
+
+bool check_pair_integer(const Cached_Triangle& t, const point& p) {
+    int32_t grid[3][3], coords[3];
+    for(int vertex = 0; vertex < 3; ++vertex) grid_coords(t.coords.v[vertex], grid[vertex]);
+    point_coords(p, coords);
+    return is_triangle_and_point_intersects_exact(grid, coords);
+}
+
+bool check_pair_integer(const Cut& c1, const Cut& c2) {
+    int32_t begin1[3], end1[3], begin2[3], end2[3];
+    cut_ends(c1, begin1, end1);
+    cut_ends(c2, begin2, end2);
+    return is_cuts_intersects_exact(begin1, end1, begin2, end2);
+}
+
+bool check_pair_integer(const Cut& c, const point& p) {
+    int32_t begin[3], end[3], coords[3];
+    cut_ends(c, begin, end);
+    point_coords(p, coords);
+    return is_cut_and_point_intersects_exact(begin, end, coords);
+}
+
+bool check_pair_integer(const point& p1, const point& p2) {
+    int32_t coords1[3], coords2[3];
+    point_coords(p1, coords1);
+    point_coords(p2, coords2);
+    return is_points_match_exact(coords1, coords2);
+}
+
+plane_test_result plane_test(const Cached_Triangle& t1, const Cached_Triangle& t2) {
+    return triangles_plane_test(t1.coords, t2.coords);
+}
+
+plane_test_result plane_test(const Cached_Triangle& t, const Cut& c) {
+    double begin[3], end[3];
+    cut_ends(c, begin, end);
+    return triangle_and_cut_plane_test(t.coords, begin, end);
+}
+
+plane_test_result plane_test(const Cached_Triangle& t, const point& p) {
+    const double coords[3] = {p.x(), p.y(), p.z()};
+    return triangle_and_point_plane_test(t.coords, coords);
+}
+
+std::vector<Stored_Object_Ref> stored_objects_refs(const Geometry_Object_Storage& objects) {
+    if(objects.capacity() > UINT32_MAX) throw std::invalid_argument("too many objects in storage");
+
+    std::vector<Stored_Object_Ref> refs;
+    refs.reserve(objects.capacity());
+    for(size_t i = 0; i < objects.triangles().size(); ++i) {
+        refs.push_back(Stored_Object_Ref{TRIANGLE, static_cast<uint32_t>(i)});
+    }
+    for(size_t i = 0; i < objects.cuts().size(); ++i) {
+        refs.push_back(Stored_Object_Ref{CUT, static_cast<uint32_t>(i)});
+    }
+    for(size_t i = 0; i < objects.points().size(); ++i) {
+        refs.push_back(Stored_Object_Ref{POINT, static_cast<uint32_t>(i)});
+    }
+    return refs;
+}
+
+Bounding_Box stored_object_box(const Geometry_Object_Storage& objects, g_obj_type type, size_t index) {
+    if(type == TRIANGLE) return objects.triangle_caches()[index].box;
+    if(type == CUT) return Bounding_Box(objects.cuts()[index]);
+    assert(type == POINT);
+    return Bounding_Box(objects.points()[index]);
+}
+
+size_t stored_object_number(const Geometry_Object_Storage& objects, g_obj_type type, size_t index) {
+    if(type == TRIANGLE) return objects.triangles()[index].number();
+    if(type == CUT) return objects.cuts()[index].number();
+    assert(type == POINT);
+    return objects.points()[index].number();
+}
+
+} //namespace geometry
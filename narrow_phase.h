@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+#include "tri_tri_kernel.h"
+#include "finder_stats.h"
+
+namespace geometry {
+
+//--------------------------------------Narrow_Phase-------------------------------
+
+//Exact checks of two objects of any kinds for finders and indexes
+//which keep objects of storage by kind and index.
+//Triangles are checked with their caches, so they are never prepared again.
+
+bool check_pair(const Cached_Triangle& t1, const Cached_Triangle& t2);
+bool check_pair(const Cached_Triangle& t, const Cut& c);
+bool check_pair(const Cached_Triangle& t, const point& p);
+inline bool check_pair(const Cut& c, const Cached_Triangle& t) { return check_pair(t, c); }
+inline bool check_pair(const point& p, const Cached_Triangle& t) { return check_pair(t, p); }
+
+//cuts and points are checked with each other by Geometry_Object
+inline bool check_pair(const Cut& c1, const Cut& c2) { return Geometry_Object::check_intersection(c1, c2); }
+inline bool check_pair(const Cut& c, const point& p) { return Geometry_Object::check_intersection(c, p); }
+inline bool check_pair(const point& p, const Cut& c) { return Geometry_Object::check_intersection(c, p); }
+inline bool check_pair(const point& p1, const point& p2) { return Geometry_Object::check_intersection(p1, p2); }
+
+//the same checks by exact predicates, objects intersect only if they have a common point
+bool check_pair_exact(const Cached_Triangle& t1, const Cached_Triangle& t2);
+bool check_pair_exact(const Cached_Triangle& t, const Cut& c);
+bool check_pair_exact(const Cached_Triangle& t, const point& p);
+bool check_pair_exact(const Cut& c1, const Cut& c2);
+bool check_pair_exact(const Cut& c, const point& p);
+bool check_pair_exact(const point& p1, const point& p2);
+inline bool check_pair_exact(const Cut& c, const Cached_Triangle& t) { return check_pair_exact(t, c); }
+inline bool check_pair_exact(const point& p, const Cached_Triangle& t) { return check_pair_exact(t, p); }
+inline bool check_pair_exact(const point& p, const Cut& c) { return check_pair_exact(c, p); }
+
+//the same checks for integer grid (see fixed_decimal.h)
+bool is_triangles_intersects_integer(const Triangle_Coords& t1, const Triangle_Coords& t2);
+bool check_pair_integer(const Cached_Triangle& t1, const Cached_Triangle& t2);
+bool check_pair_integer(const Cached_Triangle& t, const Cut& c);
+bool check_pair_integer(const Cached_Triangle& t, const point& p);
+bool check_pair_integer(const Cut& c1, const Cut& c2);
+bool check_pair_integer(const Cut& c, const point& p);
+bool check_pair_integer(const point& p1, const point& p2);
+inline bool check_pair_integer(const Cut& c, const Cached_Triangle& t) { return check_pair_integer(t, c); }
+inline bool check_pair_integer(const point& p, const Cached_Triangle& t) { return check_pair_integer(t, p); }
+inline bool check_pair_integer(const point& p, const Cut& c) { return check_pair_integer(c, p); }
+
+template <typename T1, typename T2>
+bool check_pair(const T1& obj1, const T2& obj2, predicate_kind predicates) {
+    if(predicates == EXACT_PREDICATES) return check_pair_exact(obj1, obj2);
+    if(predicates == INTEGER_PREDICATES) return check_pair_integer(obj1, obj2);
+    return check_pair(obj1, obj2);
+}
+
+inline g_obj_type shape_type(const Cached_Triangle&) { return TRIANGLE; }
+inline g_obj_type shape_type(const Cut&) { return CUT; }
+inline g_obj_type shape_type(const point&) { return POINT; }
+
+//plane early-out of check_pair alone, plane of triangle is the first one
+plane_test_result plane_test(const Cached_Triangle& t1, const Cached_Triangle& t2);
+plane_test_result plane_test(const Cached_Triangle& t, const Cut& c);
+plane_test_result plane_test(const Cached_Triangle& t, const point& p);
+
+//check_pair which is added to stats, if they are collected
+template <typename T1, typename T2>
+bool check_pair(const T1& obj1, const T2& obj2, predicate_kind predicates, Finder_Stats* stats) {
+    if(stats == nullptr) return check_pair(obj1, obj2, predicates);
+
+    stats->add_narrow_calls(shape_type(obj1), shape_type(obj2));
+    if constexpr(std::is_same<T1, Cached_Triangle>::value) {
+        stats->add_plane_test(shape_type(obj2), plane_test(obj1, obj2));
+    }
+    else if constexpr(std::is_same<T2, Cached_Triangle>::value) {
+        stats->add_plane_test(shape_type(obj1), plane_test(obj2, obj1));
+    }
+    Phase_Timer timer(stats, NARROW_PHASE);
+    return check_pair(obj1, obj2, predicates);
+}
+
+//func(obj) where obj is Cached_Triangle, Object_Cut or Object_Point
+template <typename F>
+auto visit_stored_object(const Geometry_Object_Storage& objects, g_obj_type type, size_t index, F func) {
+    if(type == TRIANGLE) {
+        return func(Cached_Triangle{objects.triangles()[index].coords(),
+                                    objects.triangle_caches()[index]});
+    }
+    if(type == CUT) return func(objects.cuts()[index]);
+    assert(type == POINT);
+    return func(objects.points()[index]);
+}
+
+//object of storage by kind and index
+struct Stored_Object_Ref {
+    g_obj_type type;
+    uint32_t index; //in storage of its type
+};
+
+//triangles, then cuts, then points; storage must have less than 2^32 objects
+std::vector<Stored_Object_Ref> stored_objects_refs(const Geometry_Object_Storage& objects);
+Bounding_Box stored_object_box(const Geometry_Object_Storage& objects, g_obj_type type, size_t index);
+size_t stored_object_number(const Geometry_Object_Storage& objects, g_obj_type type, size_t index);
+
+} //namespace geometry
@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "pair_output.h"
+
+namespace geometry {
+
+//-----------------------------------Pair_Buffers----------------------------------
+
+std::atomic<size_t> Pair_Buffers::next_id_{0};
+
+Pair_Buffers::Thread_Chunks& Pair_Buffers::thread_chunks() {
+    //the last used buffers of thread are remembered, lock is taken only
+    //when thread writes to these buffers for the first time
+    struct Cached_Chunks {
+        size_t owner_id = SIZE_MAX;
+        Thread_Chunks* chunks = nullptr;
+    };
+    thread_local Cached_Chunks cached;
+
+    if(cached.owner_id != id_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_chunks_.emplace_back();
+        cached.owner_id = id_;
+        cached.chunks = &threads_chunks_.back();
+    }
+    return *cached.chunks;
+}
+
+void Pair_Buffers::add(size_t num1, size_t num2) {
+    if(std::max(num1, num2) > UINT32_MAX) throw std::invalid_argument("object number doesn't fit pair");
+
+    Thread_Chunks& thread = thread_chunks();
+    if(thread.last_chunk_size == CHUNK_SIZE) {
+        thread.chunks.emplace_back(new Object_Pair[CHUNK_SIZE]);
+        thread.last_chunk_size = 0;
+    }
+    thread.chunks.back()[thread.last_chunk_size++] =
+            Object_Pair{static_cast<uint32_t>(num1), static_cast<uint32_t>(num2)};
+}
+
+size_t Pair_Buffers::size() const {
+    size_t pairs_num = 0;
+    for_each_chunk([&pairs_num](const Object_Pair*, size_t size) { pairs_num += size; });
+    return pairs_num;
+}
+
+std::vector<Object_Pair> Pair_Buffers::to_vector() const {
+    std::vector<Object_Pair> pairs;
+    pairs.reserve(size());
+    for_each_chunk([&pairs](const Object_Pair* chunk, size_t size) {
+        pairs.insert(pairs.end(), chunk, chunk + size);
+    });
+    return pairs;
+}
+
+
+
+
+//--------------------------------------Pairs_File---------------------------------
+
+namespace {
+
+void put_u32(unsigned char* out, uint32_t value) {
+    for(int i = 0; i < 4; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+void put_u64(unsigned char* out, uint64_t value) {
+    for(int i = 0; i < 8; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+} //namespace
+
+void write_pairs_binary(std::ostream& out, const Pair_Buffers& pairs) {
+    unsigned char header[24] = {'T', 'R', 'I', 'P', 'A', 'I', 'R', 'S'};
+    put_u32(header + 8, PAIRS_FILE_VERSION);
+    put_u32(header + 12, 0);
+    put_u64(header + 16, pairs.size());
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    //pairs are encoded chunk by chunk, so byte order doesn't depend on processor
+    std::vector<unsigned char> bytes;
+    pairs.for_each_chunk([&out, &bytes](const Object_Pair* chunk, size_t size) {
+        bytes.resize(size * 8);
+        for(size_t k = 0; k < size; ++k) {
+            put_u32(bytes.data() + 8 * k, chunk[k].first);
+            put_u32(bytes.data() + 8 * k + 4, chunk[k].second);
+        }
+        out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    });
+
+    if(!out) throw std::runtime_error("pairs writing failed");
+}
+
+void write_pairs_binary(const std::string& file_name, const Pair_Buffers& pairs) {
+    std::ofstream out(file_name, std::ios::binary);
+    if(!out) throw std::invalid_argument("can't open pairs file " + file_name);
+    write_pairs_binary(out, pairs);
+}
+
+} //namespace geometry
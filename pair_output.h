@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace geometry {
+
+//-----------------------------------Pair_Output-----------------------------------
+
+//object numbers in order of Pair_Buffers::add: Intersection_Finder gives first < second,
+//Bipartite_Finder gives number in first set and number in second set
+struct Object_Pair {
+    uint32_t first;
+    uint32_t second;
+};
+
+//called concurrently from several threads for every intersecting pair
+using Intersection_Callback = std::function<void(size_t, size_t)>;
+
+//Pairs written by many threads: every thread fills its own chunks of fixed size,
+//so there is no locking per pair and no reallocation of one huge array.
+//Pairs can be read only when writers are finished.
+class Pair_Buffers final {
+private:
+    static const size_t CHUNK_SIZE = 4096;
+
+    struct Thread_Chunks {
+        std::vector<std::unique_ptr<Object_Pair[]>> chunks;
+        size_t last_chunk_size = CHUNK_SIZE; //new chunk is needed at first
+    };
+
+    //every buffers object has its own id, so threads never mix
+    //their cached chunks of different objects
+    static std::atomic<size_t> next_id_;
+    size_t id_;
+    std::mutex mutex_;
+    std::deque<Thread_Chunks> threads_chunks_; //deque keeps addresses
+
+    Thread_Chunks& thread_chunks();
+public:
+    Pair_Buffers(): id_(next_id_.fetch_add(1)) {}
+    Pair_Buffers(const Pair_Buffers&) = delete;
+    Pair_Buffers& operator=(const Pair_Buffers&) = delete;
+
+    //order of numbers is kept
+    void add(size_t num1, size_t num2);
+    //callback for Finder_Settings, buffers must live until search ends
+    Intersection_Callback callback() {
+        return [this](size_t num1, size_t num2) { add(num1, num2); };
+    }
+
+    size_t size() const;
+    //order of pairs is unspecified
+    template <typename F>
+    void for_each_chunk(F func) const {
+        for(const Thread_Chunks& thread : threads_chunks_) {
+            for(size_t k = 0; k < thread.chunks.size(); ++k) {
+                const bool is_last = (k + 1 == thread.chunks.size());
+                func(thread.chunks[k].get(), is_last ? thread.last_chunk_size : CHUNK_SIZE);
+            }
+        }
+    }
+    std::vector<Object_Pair> to_vector() const;
+};
+
+//Binary pairs file, all numbers are little endian:
+//8 bytes "TRIPAIRS", uint32 version, uint32 reserved (0), uint64 pairs number,
+//then pairs as two uint32 object numbers
+const uint32_t PAIRS_FILE_VERSION = 1;
+
+void write_pairs_binary(std::ostream& out, const Pair_Buffers& pairs);
+void write_pairs_binary(const std::string& file_name, const Pair_Buffers& pairs);
+
+} //namespace geometry
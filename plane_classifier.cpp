@@ -0,0 +1,338 @@
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "plane_classifier.h"
+#include "exact_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace geometry {
+
+namespace {
+
+//records are read as arrays of doubles: coordinates are at their beginning
+const size_t RECORD_STRIDE = sizeof(Triangle_Record) / sizeof(double);
+static_assert(sizeof(Triangle_Record) % sizeof(double) == 0,
+              "records must be gathered with double stride");
+
+const double* records_base(const Triangle_Record* records) {
+    return &records[0].coords().v[0][0];
+}
+
+//float coordinates are gathered by 32-bit offsets from the first triangle
+const size_t FLOAT_STRIDE = sizeof(Scalar_Triangle<float>) / sizeof(float);
+const size_t MAX_GATHERED_TRIANGLES = INT32_MAX / FLOAT_STRIDE;
+
+int8_t side_by_masks(int lane, int above, int below) {
+    if((above >> lane) & 1) return 1;
+    if((below >> lane) & 1) return -1;
+    return 0;
+}
+
+void classify_scalar(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                     const Plane& pl, int8_t* sides) {
+    for(size_t k = 0; k < count; ++k) {
+        sides[k] = static_cast<int8_t>(records[indexes[k]].side_plane(pl));
+    }
+}
+
+void classify_float_scalar(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                           size_t count, const Scalar_Plane<float>& pl, int8_t* sides) {
+    for(size_t k = 0; k < count; ++k) {
+        sides[k] = static_cast<int8_t>(triangle_side_plane(pl, triangles[indexes[k]]));
+    }
+}
+
+#ifdef GEOMETRY_X86_SIMD
+
+//sums are made in the same order as in Plane::point_side_plane,
+//so every lane gives exactly the scalar result
+__attribute__((target("sse2")))
+void classify_sse2(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                   const Plane& pl, int8_t* sides) {
+    const double* base = records_base(records);
+    const __m128d a = _mm_set1_pd(pl.A()), b = _mm_set1_pd(pl.B());
+    const __m128d c = _mm_set1_pd(pl.C()), d = _mm_set1_pd(pl.D());
+    const __m128d gap = _mm_set1_pd(DOUBLE_GAP), neg_gap = _mm_set1_pd(-DOUBLE_GAP);
+
+    size_t k = 0;
+    for(; k + 2 <= count; k += 2) {
+        const double* t0 = base + indexes[k] * RECORD_STRIDE;
+        const double* t1 = base + indexes[k + 1] * RECORD_STRIDE;
+        __m128d above = _mm_castsi128_pd(_mm_set1_epi32(-1));
+        __m128d below = above;
+        for(int v = 0; v < 9; v += 3) {
+            __m128d x = _mm_set_pd(t1[v], t0[v]);
+            __m128d y = _mm_set_pd(t1[v + 1], t0[v + 1]);
+            __m128d z = _mm_set_pd(t1[v + 2], t0[v + 2]);
+            __m128d dist = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, a), _mm_mul_pd(y, b)),
+                                                 _mm_mul_pd(z, c)), d);
+            above = _mm_and_pd(above, _mm_cmpgt_pd(dist, gap));
+            below = _mm_and_pd(below, _mm_cmplt_pd(dist, neg_gap));
+        }
+        const int above_mask = _mm_movemask_pd(above), below_mask = _mm_movemask_pd(below);
+        for(int lane = 0; lane < 2; ++lane) {
+            sides[k + lane] = side_by_masks(lane, above_mask, below_mask);
+        }
+    }
+    classify_scalar(records, indexes + k, count - k, pl, sides + k);
+}
+
+__attribute__((target("avx2")))
+void classify_avx2(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                   const Plane& pl, int8_t* sides) {
+    const double* base = records_base(records);
+    const __m256d a = _mm256_set1_pd(pl.A()), b = _mm256_set1_pd(pl.B());
+    const __m256d c = _mm256_set1_pd(pl.C()), d = _mm256_set1_pd(pl.D());
+    const __m256d gap = _mm256_set1_pd(DOUBLE_GAP), neg_gap = _mm256_set1_pd(-DOUBLE_GAP);
+
+    size_t k = 0;
+    for(; k + 4 <= count; k += 4) {
+        const double* t[4];
+        for(int lane = 0; lane < 4; ++lane) {
+            t[lane] = base + indexes[k + lane] * RECORD_STRIDE;
+        }
+
+        __m256d above = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+        __m256d below = above;
+        for(int v = 0; v < 9; v += 3) {
+            __m256d x = _mm256_set_pd(t[3][v], t[2][v], t[1][v], t[0][v]);
+            __m256d y = _mm256_set_pd(t[3][v + 1], t[2][v + 1], t[1][v + 1], t[0][v + 1]);
+            __m256d z = _mm256_set_pd(t[3][v + 2], t[2][v + 2], t[1][v + 2], t[0][v + 2]);
+            __m256d dist = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, a),
+                                                                     _mm256_mul_pd(y, b)),
+                                                       _mm256_mul_pd(z, c)), d);
+            above = _mm256_and_pd(above, _mm256_cmp_pd(dist, gap, _CMP_GT_OQ));
+            below = _mm256_and_pd(below, _mm256_cmp_pd(dist, neg_gap, _CMP_LT_OQ));
+        }
+        const int above_mask = _mm256_movemask_pd(above), below_mask = _mm256_movemask_pd(below);
+        for(int lane = 0; lane < 4; ++lane) {
+            sides[k + lane] = side_by_masks(lane, above_mask, below_mask);
+        }
+    }
+    classify_scalar(records, indexes + k, count - k, pl, sides + k);
+}
+
+__attribute__((target("avx512f")))
+void classify_avx512(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                     const Plane& pl, int8_t* sides) {
+    const double* base = records_base(records);
+    const __m512d a = _mm512_set1_pd(pl.A()), b = _mm512_set1_pd(pl.B());
+    const __m512d c = _mm512_set1_pd(pl.C()), d = _mm512_set1_pd(pl.D());
+    const __m512d gap = _mm512_set1_pd(DOUBLE_GAP), neg_gap = _mm512_set1_pd(-DOUBLE_GAP);
+
+    size_t k = 0;
+    for(; k + 8 <= count; k += 8) {
+        const double* t[8];
+        for(int lane = 0; lane < 8; ++lane) {
+            t[lane] = base + indexes[k + lane] * RECORD_STRIDE;
+        }
+
+        __mmask8 above = 0xFF, below = 0xFF;
+        for(int v = 0; v < 9; v += 3) {
+            __m512d x = _mm512_set_pd(t[7][v], t[6][v], t[5][v], t[4][v],
+                                      t[3][v], t[2][v], t[1][v], t[0][v]);
+            __m512d y = _mm512_set_pd(t[7][v + 1], t[6][v + 1], t[5][v + 1], t[4][v + 1],
+                                      t[3][v + 1], t[2][v + 1], t[1][v + 1], t[0][v + 1]);
+            __m512d z = _mm512_set_pd(t[7][v + 2], t[6][v + 2], t[5][v + 2], t[4][v + 2],
+                                      t[3][v + 2], t[2][v + 2], t[1][v + 2], t[0][v + 2]);
+            __m512d dist = _mm512_add_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(x, a),
+                                                                     _mm512_mul_pd(y, b)),
+                                                       _mm512_mul_pd(z, c)), d);
+            above &= _mm512_cmp_pd_mask(dist, gap, _CMP_GT_OQ);
+            below &= _mm512_cmp_pd_mask(dist, neg_gap, _CMP_LT_OQ);
+        }
+        for(int lane = 0; lane < 8; ++lane) {
+            sides[k + lane] = side_by_masks(lane, above, below);
+        }
+    }
+    classify_scalar(records, indexes + k, count - k, pl, sides + k);
+}
+
+//float copies: lanes are twice as many as for doubles
+
+__attribute__((target("sse2")))
+void classify_float_sse2(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                         size_t count, const Scalar_Plane<float>& pl, int8_t* sides) {
+    const __m128 a = _mm_set1_ps(pl.a), b = _mm_set1_ps(pl.b);
+    const __m128 c = _mm_set1_ps(pl.c), d = _mm_set1_ps(pl.d);
+    const __m128 gap = _mm_set1_ps(pl.gap), neg_gap = _mm_set1_ps(-pl.gap);
+
+    size_t k = 0;
+    for(; k + 4 <= count; k += 4) {
+        const float* t[4];
+        for(int lane = 0; lane < 4; ++lane) {
+            t[lane] = &triangles[indexes[k + lane]].v[0][0];
+        }
+
+        __m128 above = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        __m128 below = above;
+        for(int v = 0; v < 9; v += 3) {
+            __m128 x = _mm_set_ps(t[3][v], t[2][v], t[1][v], t[0][v]);
+            __m128 y = _mm_set_ps(t[3][v + 1], t[2][v + 1], t[1][v + 1], t[0][v + 1]);
+            __m128 z = _mm_set_ps(t[3][v + 2], t[2][v + 2], t[1][v + 2], t[0][v + 2]);
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, a), _mm_mul_ps(y, b)),
+                                                _mm_mul_ps(z, c)), d);
+            above = _mm_and_ps(above, _mm_cmpgt_ps(dist, gap));
+            below = _mm_and_ps(below, _mm_cmplt_ps(dist, neg_gap));
+        }
+        const int above_mask = _mm_movemask_ps(above), below_mask = _mm_movemask_ps(below);
+        for(int lane = 0; lane < 4; ++lane) {
+            sides[k + lane] = side_by_masks(lane, above_mask, below_mask);
+        }
+    }
+    classify_float_scalar(triangles, indexes + k, count - k, pl, sides + k);
+}
+
+__attribute__((target("avx2")))
+void classify_float_avx2(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                         size_t count, const Scalar_Plane<float>& pl, int8_t* sides) {
+    const __m256 a = _mm256_set1_ps(pl.a), b = _mm256_set1_ps(pl.b);
+    const __m256 c = _mm256_set1_ps(pl.c), d = _mm256_set1_ps(pl.d);
+    const __m256 gap = _mm256_set1_ps(pl.gap), neg_gap = _mm256_set1_ps(-pl.gap);
+
+    const float* base = &triangles[0].v[0][0];
+    const __m256i stride = _mm256_set1_epi32(static_cast<int>(FLOAT_STRIDE));
+
+    size_t k = 0;
+    for(; k + 8 <= count; k += 8) {
+        const __m256i offsets = _mm256_mullo_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes + k)), stride);
+
+        __m256 above = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        __m256 below = above;
+        for(int v = 0; v < 9; v += 3) {
+            __m256 x = _mm256_i32gather_ps(base + v, offsets, 4);
+            __m256 y = _mm256_i32gather_ps(base + v + 1, offsets, 4);
+            __m256 z = _mm256_i32gather_ps(base + v + 2, offsets, 4);
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, a),
+                                                                    _mm256_mul_ps(y, b)),
+                                                      _mm256_mul_ps(z, c)), d);
+            above = _mm256_and_ps(above, _mm256_cmp_ps(dist, gap, _CMP_GT_OQ));
+            below = _mm256_and_ps(below, _mm256_cmp_ps(dist, neg_gap, _CMP_LT_OQ));
+        }
+        const int above_mask = _mm256_movemask_ps(above), below_mask = _mm256_movemask_ps(below);
+        for(int lane = 0; lane < 8; ++lane) {
+            sides[k + lane] = side_by_masks(lane, above_mask, below_mask);
+        }
+    }
+    classify_float_scalar(triangles, indexes + k, count - k, pl, sides + k);
+}
+
+__attribute__((target("avx512f")))
+void classify_float_avx512(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                           size_t count, const Scalar_Plane<float>& pl, int8_t* sides) {
+    const __m512 a = _mm512_set1_ps(pl.a), b = _mm512_set1_ps(pl.b);
+    const __m512 c = _mm512_set1_ps(pl.c), d = _mm512_set1_ps(pl.d);
+    const __m512 gap = _mm512_set1_ps(pl.gap), neg_gap = _mm512_set1_ps(-pl.gap);
+
+    const float* base = &triangles[0].v[0][0];
+    const __m512i stride = _mm512_set1_epi32(static_cast<int>(FLOAT_STRIDE));
+    //masked gathers with zero source, unmasked ones read uninitialized source in gcc headers
+    const __m512 zero = _mm512_setzero_ps();
+    const __mmask16 all_lanes = 0xFFFF;
+
+    size_t k = 0;
+    for(; k + 16 <= count; k += 16) {
+        const __m512i offsets = _mm512_mullo_epi32(_mm512_loadu_si512(indexes + k), stride);
+
+        __mmask16 above = 0xFFFF, below = 0xFFFF;
+        for(int v = 0; v < 9; v += 3) {
+            __m512 x = _mm512_mask_i32gather_ps(zero, all_lanes, offsets, base + v, 4);
+            __m512 y = _mm512_mask_i32gather_ps(zero, all_lanes, offsets, base + v + 1, 4);
+            __m512 z = _mm512_mask_i32gather_ps(zero, all_lanes, offsets, base + v + 2, 4);
+            __m512 dist = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x, a),
+                                                                    _mm512_mul_ps(y, b)),
+                                                      _mm512_mul_ps(z, c)), d);
+            above &= _mm512_cmp_ps_mask(dist, gap, _CMP_GT_OQ);
+            below &= _mm512_cmp_ps_mask(dist, neg_gap, _CMP_LT_OQ);
+        }
+        for(int lane = 0; lane < 16; ++lane) {
+            sides[k + lane] = side_by_masks(lane, above, below);
+        }
+    }
+    classify_float_scalar(triangles, indexes + k, count - k, pl, sides + k);
+}
+
+#endif //GEOMETRY_X86_SIMD
+
+} //namespace
+
+void classify_triangles(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                        const Plane& pl, int8_t* sides) {
+    classify_triangles(records, indexes, count, pl, sides, best_simd_level());
+}
+
+void classify_triangles(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                        const Plane& pl, int8_t* sides, simd_level level) {
+    switch(level) {
+#ifdef GEOMETRY_X86_SIMD
+    case AVX512_SIMD:
+        classify_avx512(records, indexes, count, pl, sides);
+        return;
+    case AVX2_SIMD:
+        classify_avx2(records, indexes, count, pl, sides);
+        return;
+    case SSE2_SIMD:
+        classify_sse2(records, indexes, count, pl, sides);
+        return;
+#endif
+    default:
+        classify_scalar(records, indexes, count, pl, sides);
+    }
+}
+
+void classify_triangles(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                        size_t count, const Scalar_Plane<float>& pl, int8_t* sides) {
+    classify_triangles(triangles, indexes, count, pl, sides, best_simd_level());
+}
+
+void classify_triangles(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                        size_t count, const Scalar_Plane<float>& pl, int8_t* sides,
+                        simd_level level) {
+    if(count == 0) return;
+    assert((level <= SSE2_SIMD) ||
+           (*std::max_element(indexes, indexes + count) < MAX_GATHERED_TRIANGLES));
+    switch(level) {
+#ifdef GEOMETRY_X86_SIMD
+    case AVX512_SIMD:
+        classify_float_avx512(triangles, indexes, count, pl, sides);
+        return;
+    case AVX2_SIMD:
+        classify_float_avx2(triangles, indexes, count, pl, sides);
+        return;
+    case SSE2_SIMD:
+        classify_float_sse2(triangles, indexes, count, pl, sides);
+        return;
+#endif
+    default:
+        classify_float_scalar(triangles, indexes, count, pl, sides);
+    }
+}
+
+void classify_triangles(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                        const Split_Plane& pl, int8_t* sides) {
+    if(pl.is_exact) {
+        for(size_t k = 0; k < count; ++k) {
+            sides[k] = static_cast<int8_t>(triangle_side_exact(pl.v, records[indexes[k]].coords().v));
+        }
+    }
+    else if(pl.float_triangles != nullptr) {
+        const std::vector<Scalar_Triangle<float>>& triangles = pl.float_triangles->triangles();
+        simd_level level = best_simd_level();
+        //offsets of gathers must fit in 32 bits, SSE2 loads triangles by pointers
+        if(triangles.size() > MAX_GATHERED_TRIANGLES) level = std::min(level, SSE2_SIMD);
+        classify_triangles(triangles.data(), indexes, count, pl.float_pl, sides, level);
+    }
+    else {
+        classify_triangles(records, indexes, count, pl.pl, sides);
+    }
+}
+
+} //namespace geometry
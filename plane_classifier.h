@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "geometry.h"
+#include "triangle_record.h"
+#include "simd_level.h"
+
+namespace geometry {
+
+//------------------------------------Plane_Classifier-----------------------------
+
+//how sides of all split planes of one search are computed
+struct Split_Kind {
+    bool is_exact;
+    const Scalar_Triangles<float>* float_triangles; //null if triangles are classified in double
+};
+
+//Plane of split: tolerance sides are computed by pl,
+//exact sides by three points of the plane (see exact_kernel.h),
+//if float_triangles is set, triangles are classified by their copies and float_pl
+struct Split_Plane {
+    Plane pl;
+    double v[3][3];  //[point][axis]
+    bool is_exact;
+    const Scalar_Triangles<float>* float_triangles;
+    Scalar_Plane<float> float_pl;
+};
+
+//Side masks of many triangles at once: sides[k] is
+//records[indexes[k]].side_plane(pl) (-1, 0 or 1).
+//Vertex coordinates of 2, 4 or 8 triangles are gathered into vector registers
+//and the plane is evaluated for all of them together.
+void classify_triangles(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                        const Plane& pl, int8_t* sides);
+//level must be supported by processor
+void classify_triangles(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                        const Plane& pl, int8_t* sides, simd_level level);
+//the same for float copies of triangles, sides[k] is
+//triangle_side_plane(pl, triangles[indexes[k]]), lanes are 4, 8 or 16 floats
+void classify_triangles(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                        size_t count, const Scalar_Plane<float>& pl, int8_t* sides);
+//gathers of AVX2 and AVX-512 levels take indexes below INT32_MAX / 9 only
+void classify_triangles(const Scalar_Triangle<float>* triangles, const uint32_t* indexes,
+                        size_t count, const Scalar_Plane<float>& pl, int8_t* sides,
+                        simd_level level);
+//sides of kind of split plane: exact ones are computed one by one, float or double as above
+void classify_triangles(const Triangle_Record* records, const uint32_t* indexes, size_t count,
+                        const Split_Plane& pl, int8_t* sides);
+
+} //namespace geometry
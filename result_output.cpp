@@ -0,0 +1,168 @@
+#include <cstdint>
+#include <cstdlib>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#include "result_output.h"
+
+namespace geometry {
+
+//-----------------------------------Result_Output---------------------------------
+
+namespace {
+
+const size_t BUFFER_SIZE = 1 << 16;
+const size_t MAX_NUMBER_SIZE = 20;  //digits of uint64_t
+
+class Output_Buffer final {
+private:
+    std::ostream& out_;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+
+    void reserve(size_t size) {
+        if(size_ + size > buffer_.size()) flush();
+    }
+public:
+    explicit Output_Buffer(std::ostream& out): out_(out), buffer_(BUFFER_SIZE) {}
+    Output_Buffer(const Output_Buffer&) = delete;
+    Output_Buffer& operator=(const Output_Buffer&) = delete;
+
+    void put(char c) {
+        reserve(1);
+        buffer_[size_++] = c;
+    }
+    //only short literals are put, they always fit buffer
+    void put(const char* text) {
+        const size_t size = std::strlen(text);
+        reserve(size);
+        std::memcpy(buffer_.data() + size_, text, size);
+        size_ += size;
+    }
+    void put_number(uint64_t value) {
+        reserve(MAX_NUMBER_SIZE);
+        char* const begin = buffer_.data() + size_;
+        size_ = std::to_chars(begin, begin + MAX_NUMBER_SIZE, value).ptr - buffer_.data();
+    }
+    void put_little_endian(uint64_t value, int bytes) {
+        for(int i = 0; i < bytes; ++i) put(static_cast<char>(value >> (8 * i)));
+    }
+
+    //stream state is checked by caller
+    void flush() {
+        out_.write(buffer_.data(), size_);
+        size_ = 0;
+    }
+};
+
+void check_stream(const std::ostream& out) {
+    if(!out) throw std::runtime_error("results writing failed");
+}
+
+} //namespace
+
+result_format parse_result_format(const std::string& name) {
+    if(name == "text") return TEXT_RESULT;
+    if(name == "rle") return RLE_RESULT;
+    if(name == "bitset") return BITSET_RESULT;
+    if(name == "json") return JSON_RESULT;
+    throw std::invalid_argument("unknown result format " + name);
+}
+
+void write_flags(std::ostream& out, const std::vector<bool>& flags, result_format format,
+                 const uint64_t* ids) {
+    Output_Buffer buffer(out);
+    auto object_id = [ids](size_t num) { return (ids != nullptr) ? ids[num] : uint64_t(num); };
+
+    switch(format) {
+    case TEXT_RESULT:
+        for(size_t k = 0; k < flags.size(); ++k) {
+            if(!flags[k]) continue;
+            buffer.put_number(object_id(k));
+            buffer.put('\n');
+        }
+        break;
+    case RLE_RESULT: {
+        buffer.put_number(flags.size());
+        buffer.put('\n');
+        bool run_flag = false;
+        size_t run = 0;
+        for(size_t k = 0; k < flags.size(); ++k) {
+            if(flags[k] != run_flag) {
+                buffer.put_number(run);
+                buffer.put(' ');
+                run_flag = flags[k];
+                run = 0;
+            }
+            ++run;
+        }
+        buffer.put_number(run);
+        buffer.put('\n');
+        break;
+    }
+    case BITSET_RESULT: {
+        buffer.put("TRIFLAGS");
+        buffer.put_little_endian(FLAGS_FILE_VERSION, 4);
+        buffer.put_little_endian(0, 4);
+        buffer.put_little_endian(flags.size(), 8);
+        unsigned char byte = 0;
+        for(size_t k = 0; k < flags.size(); ++k) {
+            if(flags[k]) byte |= static_cast<unsigned char>(1 << (k % 8));
+            if(k % 8 == 7) {
+                buffer.put(static_cast<char>(byte));
+                byte = 0;
+            }
+        }
+        if(flags.size() % 8 != 0) buffer.put(static_cast<char>(byte));
+        break;
+    }
+    case JSON_RESULT: {
+        buffer.put("{\"objects_num\": ");
+        buffer.put_number(flags.size());
+        buffer.put(", \"intersecting\": [");
+        bool is_first = true;
+        for(size_t k = 0; k < flags.size(); ++k) {
+            if(!flags[k]) continue;
+            if(!is_first) buffer.put(", ");
+            buffer.put_number(object_id(k));
+            is_first = false;
+        }
+        buffer.put("]}\n");
+        break;
+    }
+    }
+    buffer.flush();
+    check_stream(out);
+}
+
+void write_pairs(std::ostream& out, const Pair_Buffers& pairs, result_format format,
+                 const uint64_t* ids) {
+    if(format == BITSET_RESULT) {
+        write_pairs_binary(out, pairs);
+        return;
+    }
+    if(format == RLE_RESULT) throw std::invalid_argument("pairs have no rle format");
+
+    Output_Buffer buffer(out);
+    auto object_id = [ids](uint32_t num) { return (ids != nullptr) ? ids[num] : uint64_t(num); };
+
+    const bool is_json = (format == JSON_RESULT);
+    if(is_json) buffer.put("{\"pairs\": [");
+    bool is_first = true;
+    pairs.for_each_chunk([&](const Object_Pair* chunk, size_t size) {
+        for(size_t k = 0; k < size; ++k) {
+            if(is_json) buffer.put(is_first ? "[" : ", [");
+            buffer.put_number(object_id(chunk[k].first));
+            buffer.put(is_json ? ", " : " ");
+            buffer.put_number(object_id(chunk[k].second));
+            buffer.put(is_json ? "]" : "\n");
+            is_first = false;
+        }
+    });
+    if(is_json) buffer.put("]}\n");
+    buffer.flush();
+    check_stream(out);
+}
+
+} //namespace geometry
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "pair_output.h"
+
+namespace geometry {
+
+//-----------------------------------Result_Output---------------------------------
+
+//Results are formatted by std::to_chars into one big buffer, which goes to stream
+//when it's full, so there is no flush per line and no string per number.
+//Formats of intersection flags:
+//  TEXT_RESULT: numbers of intersecting objects, one per line,
+//  RLE_RESULT: "objects_num\n", then lengths of runs of equal flags separated
+//              by spaces and ended by "\n", runs begin with not intersecting objects
+//              (so the first run may be 0),
+//  BITSET_RESULT: 8 bytes "TRIFLAGS", uint32 version, uint32 reserved (0),
+//                 uint64 objects number, then flag k is bit k % 8 of byte k / 8,
+//                 numbers are little endian like in pairs file,
+//  JSON_RESULT: {"objects_num": N, "intersecting": [numbers]}.
+//Text and JSON write ids[k] instead of k if ids are given (scene ids),
+//bitmaps are always indexed by object numbers.
+enum result_format {TEXT_RESULT, RLE_RESULT, BITSET_RESULT, JSON_RESULT};
+
+const uint32_t FLAGS_FILE_VERSION = 1;
+
+//"text", "rle", "bitset" or "json", throws std::invalid_argument for other names
+result_format parse_result_format(const std::string& name);
+
+void write_flags(std::ostream& out, const std::vector<bool>& flags, result_format format,
+                 const uint64_t* ids = nullptr);
+
+//pairs are "first second" lines in TEXT_RESULT, {"pairs": [[first, second], ...]}
+//in JSON_RESULT and binary pairs file in BITSET_RESULT, they have no RLE_RESULT
+void write_pairs(std::ostream& out, const Pair_Buffers& pairs, result_format format,
+                 const uint64_t* ids = nullptr);
+
+} //namespace geometry
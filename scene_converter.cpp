@@ -0,0 +1,49 @@
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+#include "scene_file.h"
+#include "text_scene.h"
+
+using namespace geometry;
+
+//Converts text input (objects number, then 9 coordinates of every object)
+//to binary scene of scene_file.h.
+//Usage: scene_converter input.txt output.scene [--float32] [--indexed]
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "usage: scene_converter input.txt output.scene [--float32] [--indexed]\n";
+        return 1;
+    }
+
+    uint32_t flags = 0;
+    for(int i = 3; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if(arg == "--float32") flags |= SCENE_FLOAT32;
+        else if(arg == "--indexed") flags |= SCENE_INDEXED;
+        else {
+            std::cerr << "unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        const std::vector<Undefined_Object> objects = read_text_scene(argv[1]);
+        std::ofstream out(argv[2], std::ios::binary);
+        if(!out) throw std::invalid_argument(std::string("can't create ") + argv[2]);
+        write_scene(out, objects, flags);
+        std::cerr << objects.size() << " objects written to " << argv[2] << "\n";
+    }
+    catch(const std::invalid_argument& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "scene_file.h"
+
+namespace geometry {
+
+//--------------------------------------Scene_File---------------------------------
+
+//blocks are read in place and written from memory as they are
+#ifdef __BYTE_ORDER__
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "scene files need little-endian host");
+#endif
+
+namespace {
+
+const uint32_t KNOWN_FLAGS = SCENE_FLOAT32 | SCENE_INDEXED | SCENE_IDS;
+
+size_t padded(size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+using Vertex = std::array<double, 3>;
+
+struct Vertex_Hash {
+    size_t operator()(const Vertex& v) const {
+        const std::hash<double> hash;
+        return hash(v[0]) ^ (hash(v[1]) * 31) ^ (hash(v[2]) * 961);
+    }
+};
+
+//vertex as it's read back: float32 scenes keep rounded coordinates
+Vertex stored_vertex(const point& p, bool is_float32) {
+    if(is_float32) {
+        return Vertex{static_cast<float>(p.x()), static_cast<float>(p.y()), static_cast<float>(p.z())};
+    }
+    return Vertex{p.x(), p.y(), p.z()};
+}
+
+void write_padding(std::ostream& out, size_t bytes) {
+    const char zeros[8] = {};
+    out.write(zeros, padded(bytes) - bytes);
+}
+
+} //namespace
+
+Mapped_Scene::Mapped_Scene(const std::string& file_name) : file_(file_name) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file_.data());
+    const size_t size = file_.size();
+
+    //blocks are checked before they are read, so broken file can't be read out of bounds
+    auto check = [&](bool is_right) {
+        if(!is_right) throw std::invalid_argument("bad scene " + file_name);
+    };
+    check(size >= sizeof(Scene_Header));
+    std::memcpy(&header_, data, sizeof(Scene_Header));
+    check(header_.magic == SCENE_MAGIC);
+    check(header_.version == SCENE_VERSION);
+    check((header_.flags & ~KNOWN_FLAGS) == 0);
+    for(uint64_t field : header_.unused) check(field == 0);
+
+    const bool is_indexed = (header_.flags & SCENE_INDEXED) != 0;
+    const size_t scalar_size = (header_.flags & SCENE_FLOAT32) ? sizeof(float) : sizeof(double);
+    check((header_.vertices_num <= size / (3 * scalar_size)) && (header_.objects_num <= size / 8));
+    check(is_indexed || (header_.vertices_num == 3 * header_.objects_num));
+
+    size_t offset = sizeof(Scene_Header);
+    vertices_ = data + offset;
+    offset += padded(header_.vertices_num * 3 * scalar_size);
+    check(offset <= size);
+    if(is_indexed) {
+        check(offset + header_.objects_num * 3 * sizeof(uint32_t) <= size);
+        indexes_ = reinterpret_cast<const uint32_t*>(data + offset);
+        offset += padded(header_.objects_num * 3 * sizeof(uint32_t));
+        for(size_t k = 0; k < header_.objects_num * 3; ++k) {
+            check(indexes_[k] < header_.vertices_num);
+        }
+    }
+    if(header_.flags & SCENE_IDS) {
+        check(offset + header_.objects_num * sizeof(uint64_t) <= size);
+        ids_ = reinterpret_cast<const uint64_t*>(data + offset);
+        offset += header_.objects_num * sizeof(uint64_t);
+    }
+    check(offset <= size);
+}
+
+point Mapped_Scene::vertex(size_t num) const {
+    if(header_.flags & SCENE_FLOAT32) {
+        const float* coords = static_cast<const float*>(vertices_) + 3 * num;
+        return point(coords[0], coords[1], coords[2]);
+    }
+    const double* coords = static_cast<const double*>(vertices_) + 3 * num;
+    return point(coords[0], coords[1], coords[2]);
+}
+
+Undefined_Object Mapped_Scene::object(size_t num) const {
+    if(indexes_ != nullptr) {
+        const uint32_t* object_indexes = indexes_ + 3 * num;
+        return Undefined_Object(vertex(object_indexes[0]), vertex(object_indexes[1]),
+                                vertex(object_indexes[2]));
+    }
+    return Undefined_Object(vertex(3 * num), vertex(3 * num + 1), vertex(3 * num + 2));
+}
+
+Geometry_Object_Storage make_storage(const Mapped_Scene& scene) {
+    Geometry_Object_Storage storage(std::vector<Undefined_Object>{});
+    for(size_t k = 0; k < scene.objects_num(); ++k) {
+        storage.add(scene.object(k), k);
+    }
+    return storage;
+}
+
+void write_scene(std::ostream& out, const std::vector<Undefined_Object>& objects, uint32_t flags,
+                 const std::vector<uint64_t>& ids) {
+    flags &= ~SCENE_IDS;
+    if(!ids.empty()) {
+        if(ids.size() != objects.size()) throw std::invalid_argument("ids aren't given for every object");
+        flags |= SCENE_IDS;
+    }
+    if((flags & ~KNOWN_FLAGS) != 0) throw std::invalid_argument("unknown scene flags");
+    const bool is_float32 = (flags & SCENE_FLOAT32) != 0;
+
+    //indexed scene: vertices in order of their first use
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indexes;
+    if(flags & SCENE_INDEXED) {
+        std::unordered_map<Vertex, uint32_t, Vertex_Hash> vertex_indexes;
+        indexes.reserve(objects.size() * 3);
+        for(const Undefined_Object& obj : objects) {
+            for(const point* p : {&obj.p1(), &obj.p2(), &obj.p3()}) {
+                const Vertex v = stored_vertex(*p, is_float32);
+                auto inserted = vertex_indexes.emplace(v, static_cast<uint32_t>(vertices.size()));
+                if(inserted.second) {
+                    if(vertices.size() == UINT32_MAX) throw std::invalid_argument("too many vertices");
+                    vertices.push_back(v);
+                }
+                indexes.push_back(inserted.first->second);
+            }
+        }
+    }
+    else {
+        vertices.reserve(objects.size() * 3);
+        for(const Undefined_Object& obj : objects) {
+            for(const point* p : {&obj.p1(), &obj.p2(), &obj.p3()}) {
+                vertices.push_back(stored_vertex(*p, is_float32));
+            }
+        }
+    }
+
+    Scene_Header header = {};
+    header.magic = SCENE_MAGIC;
+    header.version = SCENE_VERSION;
+    header.flags = flags;
+    header.objects_num = objects.size();
+    header.vertices_num = vertices.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if(is_float32) {
+        std::vector<float> coords;
+        coords.reserve(vertices.size() * 3);
+        for(const Vertex& v : vertices) coords.insert(coords.end(), v.begin(), v.end());
+        out.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(float));
+        write_padding(out, coords.size() * sizeof(float));
+    }
+    else {
+        out.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+    }
+    if(flags & SCENE_INDEXED) {
+        out.write(reinterpret_cast<const char*>(indexes.data()), indexes.size() * sizeof(uint32_t));
+        write_padding(out, indexes.size() * sizeof(uint32_t));
+    }
+    if(flags & SCENE_IDS) {
+        out.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(uint64_t));
+    }
+    if(!out) throw std::invalid_argument("can't write scene");
+}
+
+} //namespace geometry
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+#include "mapped_file.h"
+
+namespace geometry {
+
+//--------------------------------------Scene_File---------------------------------
+
+//Binary scene, numbers are little-endian and every block begins at multiple of 8 bytes:
+//  header (64 bytes),
+//  vertices: vertices_num * 3 coordinates (x, y, z) in float64 or float32 (SCENE_FLOAT32),
+//  indexes: objects_num * 3 uint32 numbers of vertices if SCENE_INDEXED,
+//           otherwise vertices of object k are 3k, 3k + 1 and 3k + 2,
+//  ids: objects_num uint64 if SCENE_IDS.
+//Objects are numbered in file order like in text input, ids are given back with results.
+//Readers must refuse versions they don't know, new blocks come with new flags.
+//Blocks are read in place, so scenes are read and written on little-endian hosts only.
+
+const uint32_t SCENE_MAGIC = 0x4e435347;  //"GSCN"
+const uint32_t SCENE_VERSION = 1;
+
+enum scene_flags : uint32_t {SCENE_FLOAT32 = 1, SCENE_INDEXED = 2, SCENE_IDS = 4};
+
+struct Scene_Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t objects_num;
+    uint64_t vertices_num;
+    uint64_t unused[4];  //zeros in version 1
+};
+
+static_assert(sizeof(Scene_Header) == 64, "scene header has fixed size");
+
+//Scene file mapped to memory: blocks are read in place, there is no parsing and no copies.
+//Objects are made from vertices when they are asked for.
+//Constructor throws std::invalid_argument if file can't be mapped or it's broken.
+class Mapped_Scene final {
+private:
+    Mapped_File file_;
+    Scene_Header header_;
+    const void* vertices_ = nullptr;
+    const uint32_t* indexes_ = nullptr;
+    const uint64_t* ids_ = nullptr;
+
+    point vertex(size_t num) const;
+public:
+    explicit Mapped_Scene(const std::string& file_name);
+
+    size_t objects_num() const { return header_.objects_num; }
+    bool has_ids() const { return ids_ != nullptr; }
+    uint64_t id(size_t num) const { return ids_[num]; }
+    //ids of all objects, nullptr if scene has no ids
+    const uint64_t* ids() const { return ids_; }
+
+    Undefined_Object object(size_t num) const;
+};
+
+//objects are added to storage right from mapped vertices, object k has number k
+Geometry_Object_Storage make_storage(const Mapped_Scene& scene);
+
+//flags are scene_flags: float32 coordinates are rounded, indexed scene keeps
+//every different vertex once, ids are written if they are given (one per object)
+void write_scene(std::ostream& out, const std::vector<Undefined_Object>& objects, uint32_t flags,
+                 const std::vector<uint64_t>& ids = {});
+
+} //namespace geometry
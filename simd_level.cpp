@@ -0,0 +1,20 @@
+#include "simd_level.h"
+
+namespace geometry {
+
+simd_level best_simd_level() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    static const simd_level level = []() {
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f")) return AVX512_SIMD;
+        if(__builtin_cpu_supports("avx2")) return AVX2_SIMD;
+        if(__builtin_cpu_supports("sse2")) return SSE2_SIMD;
+        return SCALAR_SIMD;
+    }();
+    return level;
+#else
+    return SCALAR_SIMD;
+#endif
+}
+
+} //namespace geometry
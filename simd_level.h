@@ -0,0 +1,12 @@
+#pragma once
+
+namespace geometry {
+
+//-----------------------------------------simd_level------------------------------
+
+//instruction sets of batched kernels, the best one is chosen at runtime
+enum simd_level {SCALAR_SIMD, SSE2_SIMD, AVX2_SIMD, AVX512_SIMD};
+
+simd_level best_simd_level();
+
+} //namespace geometry
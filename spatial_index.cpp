@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "spatial_index.h"
+#include "narrow_phase.h"
+
+namespace geometry {
+
+namespace {
+
+//query triangle is prepared once for all candidates
+struct Query_Triangle {
+    Triangle_Coords coords;
+    Triangle_Cache cache;
+
+    explicit Query_Triangle(const Triangle& t):
+        coords(make_triangle_coords(t)), cache(make_triangle_cache(coords)) {}
+
+    Cached_Triangle view() const { return Cached_Triangle{coords, cache}; }
+};
+
+} //namespace
+
+Spatial_Index::Spatial_Index(Geometry_Object_Storage objects):
+    objects_(std::move(objects)),
+    refs_(stored_objects_refs(objects_)),
+    tree_(objects_boxes()) {}
+
+std::vector<Bounding_Box> Spatial_Index::objects_boxes() const {
+    std::vector<Bounding_Box> boxes;
+    boxes.reserve(refs_.size());
+    for(Stored_Object_Ref ref : refs_) {
+        boxes.push_back(stored_object_box(objects_, ref.type, ref.index));
+    }
+    return boxes;
+}
+
+template <typename Query, typename F>
+void Spatial_Index::search(const Query& query, const Bounding_Box& box, F func) const {
+    tree_.for_each_overlapping_object(box, [this, &query, &func](size_t k) {
+        const Stored_Object_Ref ref = refs_[k];
+        const bool is_intersects = visit_stored_object(objects_, ref.type, ref.index,
+                [&query](const auto& obj) { return check_pair(query, obj); });
+        return is_intersects ? func(stored_object_number(objects_, ref.type, ref.index)) : true;
+    });
+}
+
+std::vector<size_t> Spatial_Index::intersecting_objects(const Triangle& t) const {
+    std::vector<size_t> numbers;
+    search(Query_Triangle(t).view(), Bounding_Box(t), [&numbers](size_t num) {
+        numbers.push_back(num);
+        return true;
+    });
+    return numbers;
+}
+
+std::vector<size_t> Spatial_Index::intersecting_objects(const Cut& c) const {
+    std::vector<size_t> numbers;
+    search(c, Bounding_Box(c), [&numbers](size_t num) {
+        numbers.push_back(num);
+        return true;
+    });
+    return numbers;
+}
+
+std::vector<size_t> Spatial_Index::intersecting_objects(const point& p) const {
+    std::vector<size_t> numbers;
+    search(p, Bounding_Box(p), [&numbers](size_t num) {
+        numbers.push_back(num);
+        return true;
+    });
+    return numbers;
+}
+
+bool Spatial_Index::is_intersects_any(const Triangle& t) const {
+    bool is_found = false;
+    search(Query_Triangle(t).view(), Bounding_Box(t), [&is_found](size_t) { return !(is_found = true); });
+    return is_found;
+}
+
+bool Spatial_Index::is_intersects_any(const Cut& c) const {
+    bool is_found = false;
+    search(c, Bounding_Box(c), [&is_found](size_t) { return !(is_found = true); });
+    return is_found;
+}
+
+bool Spatial_Index::is_intersects_any(const point& p) const {
+    bool is_found = false;
+    search(p, Bounding_Box(p), [&is_found](size_t) { return !(is_found = true); });
+    return is_found;
+}
+
+} //namespace geometry
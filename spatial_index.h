@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "geometry.h"
+#include "bvh.h"
+#include "intersection_finder.h"
+#include "narrow_phase.h"
+
+namespace geometry {
+
+//--------------------------------------Spatial_Index------------------------------
+
+//Objects of storage in BVH which is built once and then answers
+//which stored objects intersect query object, in logarithmic time for small queries.
+//Queries don't change index, so they can run concurrently.
+//Query triangle must be nondegenerate (see Plane constructor).
+class Spatial_Index final {
+private:
+    Geometry_Object_Storage objects_;
+    std::vector<Stored_Object_Ref> refs_; //refs_[k] is object k of tree
+    BVH_Tree tree_;
+
+    std::vector<Bounding_Box> objects_boxes() const;
+    //func(number) is called for every intersecting object, it returns false to stop the search
+    template <typename Query, typename F>
+    void search(const Query& query, const Bounding_Box& box, F func) const;
+public:
+    explicit Spatial_Index(Geometry_Object_Storage objects);
+
+    const Geometry_Object_Storage& objects() const { return objects_; }
+    size_t objects_num() const { return refs_.size(); }
+
+    //numbers of intersecting stored objects, order is unspecified
+    std::vector<size_t> intersecting_objects(const Triangle& t) const;
+    std::vector<size_t> intersecting_objects(const Cut& c) const;
+    std::vector<size_t> intersecting_objects(const point& p) const;
+
+    //the search stops at the first intersecting object
+    bool is_intersects_any(const Triangle& t) const;
+    bool is_intersects_any(const Cut& c) const;
+    bool is_intersects_any(const point& p) const;
+};
+
+} //namespace geometry
@@ -0,0 +1,196 @@
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "text_scene.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+namespace geometry {
+
+//--------------------------------------Text_Scene---------------------------------
+
+namespace {
+
+//smaller chunks cost more in tasks than they give in parallel parsing
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+const size_t CHUNKS_PER_THREAD = 4;
+const size_t MAX_SHOWN_TOKEN = 32;
+const size_t OBJECT_NUMBERS = 9;
+
+struct Text_Chunk {
+    const char* begin;
+    const char* end;
+    std::vector<double> numbers;
+    size_t lines = 0;  //line ends in chunk, error is on line with this number from chunk beginning
+    std::string error;
+};
+
+bool is_space(char c) {
+    return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+//beginning of next token, line ends before it are added to lines
+const char* skip_spaces(const char* pos, const char* end, size_t& lines) {
+    for(; (pos != end) && is_space(*pos); ++pos) {
+        if(*pos == '\n') ++lines;
+    }
+    return pos;
+}
+
+const char* token_end(const char* pos, const char* end) {
+    while((pos != end) && !is_space(*pos)) ++pos;
+    return pos;
+}
+
+std::string token_text(const char* begin, const char* end) {
+    if(size_t(end - begin) > MAX_SHOWN_TOKEN) return std::string(begin, MAX_SHOWN_TOKEN) + "...";
+    return std::string(begin, end);
+}
+
+//whole token is a finite number, iostream takes explicit plus and from_chars doesn't
+bool parse_number(const char* begin, const char* end, double& value) {
+    if((end - begin > 1) && (*begin == '+') && (begin[1] != '+') && (begin[1] != '-')) ++begin;
+    const std::from_chars_result result = std::from_chars(begin, end, value);
+    return (result.ec == std::errc()) && (result.ptr == end) && std::isfinite(value);
+}
+
+void parse_chunk(Text_Chunk& chunk) {
+    //numbers of generated inputs take 6-10 characters with separator
+    chunk.numbers.reserve((chunk.end - chunk.begin) / 6);
+    const char* pos = chunk.begin;
+    while(true) {
+        pos = skip_spaces(pos, chunk.end, chunk.lines);
+        if(pos == chunk.end) return;
+        const char* end = token_end(pos, chunk.end);
+        double value;
+        if(!parse_number(pos, end, value)) {
+            chunk.error = "bad number " + token_text(pos, end);
+            return;
+        }
+        chunk.numbers.push_back(value);
+        pos = end;
+    }
+}
+
+//line ends in chunk before its number num, it's called only to report error
+size_t lines_before_number(const Text_Chunk& chunk, size_t num) {
+    size_t lines = 0;
+    const char* pos = chunk.begin;
+    for(size_t i = 0; i <= num; ++i) {
+        pos = token_end(skip_spaces(pos, chunk.end, lines), chunk.end);
+    }
+    return lines;
+}
+
+std::invalid_argument line_error(size_t line, const std::string& message) {
+    return std::invalid_argument("line " + std::to_string(line) + ": " + message);
+}
+
+} //namespace
+
+std::vector<Undefined_Object> parse_text_scene(const char* text, size_t size, size_t threads_num) {
+    const char* const end = text + size;
+
+    size_t line = 1;
+    const char* pos = skip_spaces(text, end, line);
+    if(pos == end) throw line_error(line, "no objects number");
+    const char* count_end = token_end(pos, end);
+    size_t objects_num;
+    const std::from_chars_result count = std::from_chars(pos, count_end, objects_num);
+    if((count.ec != std::errc()) || (count.ptr != count_end)) {
+        throw line_error(line, "bad objects number " + token_text(pos, count_end));
+    }
+
+    //chunks end after line ends, so tokens aren't cut
+    if(threads_num == 0) threads_num = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunk_size = std::max(MIN_CHUNK_SIZE,
+                                       size_t(end - count_end) / (threads_num * CHUNKS_PER_THREAD));
+    std::vector<Text_Chunk> chunks;
+    for(const char* begin = count_end; begin != end;) {
+        const char* chunk_end = (size_t(end - begin) > chunk_size) ? begin + chunk_size : end;
+        chunk_end = std::find(chunk_end, end, '\n');
+        if(chunk_end != end) ++chunk_end;
+        chunks.push_back(Text_Chunk{begin, chunk_end, {}, 0, {}});
+        begin = chunk_end;
+    }
+
+    if(chunks.size() > 1) {
+        Work_Stealing_Pool pool(threads_num);
+        Task_Group group;
+        for(Text_Chunk& chunk : chunks) {
+            pool.submit(group, [&chunk]() { parse_chunk(chunk); });
+        }
+        pool.wait(group);
+    }
+    else if(!chunks.empty()) {
+        parse_chunk(chunks.front());
+    }
+
+    //first error in file order is reported
+    const size_t first_line = line;
+    size_t numbers_num = 0;
+    for(const Text_Chunk& chunk : chunks) {
+        if(!chunk.error.empty()) throw line_error(line + chunk.lines, chunk.error);
+        line += chunk.lines;
+        numbers_num += chunk.numbers.size();
+    }
+    if(numbers_num / OBJECT_NUMBERS < objects_num) {
+        throw line_error(line, "input ends after " + std::to_string(numbers_num / OBJECT_NUMBERS) +
+                               " of " + std::to_string(objects_num) + " objects");
+    }
+    if(numbers_num > objects_num * OBJECT_NUMBERS) {
+        size_t extra_num = objects_num * OBJECT_NUMBERS;
+        line = first_line;
+        for(const Text_Chunk& chunk : chunks) {
+            if(extra_num < chunk.numbers.size()) {
+                line += lines_before_number(chunk, extra_num);
+                break;
+            }
+            extra_num -= chunk.numbers.size();
+            line += chunk.lines;
+        }
+        throw line_error(line, "numbers after " + std::to_string(objects_num) + " objects");
+    }
+
+    std::vector<Undefined_Object> objects;
+    objects.reserve(objects_num);
+    double c[OBJECT_NUMBERS];
+    size_t filled = 0;
+    for(Text_Chunk& chunk : chunks) {
+        for(double value : chunk.numbers) {
+            c[filled++] = value;
+            if(filled < OBJECT_NUMBERS) continue;
+            objects.push_back(Undefined_Object(point(c[0], c[1], c[2]), point(c[3], c[4], c[5]),
+                                               point(c[6], c[7], c[8])));
+            filled = 0;
+        }
+        std::vector<double>().swap(chunk.numbers);
+    }
+    return objects;
+}
+
+std::vector<Undefined_Object> read_text_scene(const std::string& file_name, size_t threads_num) {
+    const Mapped_File file(file_name);
+    try {
+        return parse_text_scene(file.data(), file.size(), threads_num);
+    }
+    catch(const std::invalid_argument& e) {
+        throw std::invalid_argument(file_name + ", " + e.what());
+    }
+}
+
+std::vector<Undefined_Object> read_text_scene(std::istream& in, size_t threads_num) {
+    std::string text;
+    char block[1 << 16];
+    while(in.read(block, sizeof(block)) || (in.gcount() > 0)) {
+        text.append(block, in.gcount());
+    }
+    return parse_text_scene(text.data(), text.size(), threads_num);
+}
+
+} //namespace geometry
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdlib>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+#include "intersection_finder.h"
+
+namespace geometry {
+
+//--------------------------------------Text_Scene---------------------------------
+
+//Text input of Readme.txt: number of objects, then 9 coordinates of every object.
+//Numbers are separated by any whitespace like for iostream reading, so an object
+//may take several lines. Text is split to chunks at line ends, chunks are parsed
+//by std::from_chars in parallel and their numbers are joined in file order.
+//Broken input throws std::invalid_argument with number of line, e.g. "line 7: bad number 1.2x".
+//threads_num includes the calling thread, 0 means all hardware threads.
+
+std::vector<Undefined_Object> parse_text_scene(const char* text, size_t size, size_t threads_num = 0);
+
+//file is mapped to memory and parsed in place
+std::vector<Undefined_Object> read_text_scene(const std::string& file_name, size_t threads_num = 0);
+
+//stream is read to the end before it's parsed
+std::vector<Undefined_Object> read_text_scene(std::istream& in, size_t threads_num = 0);
+
+} //namespace geometry
@@ -0,0 +1,153 @@
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.h"
+
+namespace geometry {
+
+namespace {
+
+thread_local const Work_Stealing_Pool* cur_pool = nullptr;
+thread_local size_t cur_queue_num = 0;
+
+} //namespace
+
+//---------------------------------------Task_Group-------------------------------
+
+Task_Group::~Task_Group() {
+    //pool may be destroyed already when every task has ended
+    if((pool_ != nullptr) && !is_done()) pool_->finish(*this);
+}
+
+//-----------------------------------Work_Stealing_Pool---------------------------
+
+Work_Stealing_Pool::Work_Stealing_Pool(size_t threads_num) {
+    if(threads_num == 0) threads_num = std::thread::hardware_concurrency();
+    if(threads_num == 0) threads_num = 1;
+
+    queues_ = std::vector<Task_Queue>(threads_num);
+    workers_.reserve(threads_num - 1);
+    for(size_t i = 1; i < threads_num; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+Work_Stealing_Pool::~Work_Stealing_Pool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for(std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t Work_Stealing_Pool::current_queue() const {
+    if(cur_pool == this) return cur_queue_num;
+    return 0;
+}
+
+void Work_Stealing_Pool::submit(Task_Group& group, std::function<void()> func) {
+    group.pool_ = this;
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+    queued_.fetch_add(1, std::memory_order_release);
+
+    Task_Queue& queue = queues_[current_queue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{std::move(func), &group});
+    }
+
+    //empty critical section: sleeping worker can't miss this notification
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    sleep_cv_.notify_one();
+    wait_cv_.notify_one();
+}
+
+void Work_Stealing_Pool::finish(Task_Group& group) {
+    const size_t queue_num = current_queue();
+    while(group.is_done() == false) {
+        if(try_run_one(queue_num)) continue;
+
+        //tasks of group run on other threads: sleep until one of them ends or new task comes
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wait_cv_.wait(lock, [this, &group]() {
+            return group.is_done() || (queued_.load(std::memory_order_acquire) > 0);
+        });
+    }
+}
+
+void Work_Stealing_Pool::wait(Task_Group& group) {
+    finish(group);
+
+    if(group.error_) {
+        std::exception_ptr error = std::move(group.error_);
+        group.error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool Work_Stealing_Pool::pop_local(size_t queue_num, Task& task) {
+    Task_Queue& queue = queues_[queue_num];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool Work_Stealing_Pool::steal(size_t thief_num, Task& task) {
+    for(size_t i = 1; i < queues_.size(); ++i) {
+        Task_Queue& queue = queues_[(thief_num + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool Work_Stealing_Pool::try_run_one(size_t queue_num) {
+    Task task;
+    if((pop_local(queue_num, task) == false) && (steal(queue_num, task) == false)) {
+        return false;
+    }
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+
+    try {
+        task.func();
+    }
+    catch(...) {
+        std::lock_guard<std::mutex> lock(task.group->error_mutex_);
+        if(!task.group->error_) task.group->error_ = std::current_exception();
+    }
+    //captures may refer to the waiting scope, so they are destroyed before it's left
+    task.func = nullptr;
+
+    //waiter can leave and destroy group right after the last task, so group isn't used below
+    if(task.group->pending_.fetch_sub(1, std::memory_order_release) == 1) {
+        { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+        wait_cv_.notify_all();
+    }
+    return true;
+}
+
+void Work_Stealing_Pool::worker_loop(size_t queue_num) {
+    cur_pool = this;
+    cur_queue_num = queue_num;
+
+    while(true) {
+        if(try_run_one(queue_num)) continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this]() {
+            return stop_ || (queued_.load(std::memory_order_acquire) > 0);
+        });
+        if(stop_ && (queued_.load(std::memory_order_acquire) == 0)) return;
+    }
+}
+
+} //namespace geometry
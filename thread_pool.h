@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdlib>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace geometry {
+
+class Work_Stealing_Pool;
+
+//---------------------------------------Task_Group-------------------------------
+
+//Counts unfinished tasks submitted with it, so caller can wait for them together.
+//First exception thrown by a task is kept and rethrown from Work_Stealing_Pool::wait().
+//Tasks use data of the scope which submits them, so destructor waits for them too:
+//if this scope is left by exception, its data lives until tasks end.
+class Task_Group final {
+private:
+    std::atomic<size_t> pending_{0};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+    Work_Stealing_Pool* pool_ = nullptr; //of the first submitted task
+
+    friend class Work_Stealing_Pool;
+public:
+    Task_Group() = default;
+    ~Task_Group();
+    Task_Group(const Task_Group&) = delete;
+    Task_Group& operator=(const Task_Group&) = delete;
+
+    bool is_done() const { return pending_.load(std::memory_order_acquire) == 0; }
+};
+
+
+
+
+//-----------------------------------Work_Stealing_Pool---------------------------
+
+//Every thread owns a deque: it pushes and pops its own tasks from the back,
+//idle threads steal from the front of other deques.
+//Queue 0 belongs to threads outside the pool; thread which calls wait()
+//executes tasks too, so recursive fork-join never blocks a worker.
+class Work_Stealing_Pool final {
+private:
+    struct Task {
+        std::function<void()> func;
+        Task_Group* group;
+    };
+
+    struct Task_Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<Task_Queue> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    bool stop_ = false;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_; //idle workers
+    std::condition_variable wait_cv_;  //threads in wait() whose groups run on other threads
+
+    size_t current_queue() const;
+    bool pop_local(size_t queue_num, Task& task);
+    bool steal(size_t thief_num, Task& task);
+    bool try_run_one(size_t queue_num);
+    void worker_loop(size_t queue_num);
+    //runs tasks or sleeps until all tasks of group end, errors of tasks are left in group
+    void finish(Task_Group& group);
+
+    friend class Task_Group;
+public:
+    //threads_num includes the calling thread, 0 means all hardware threads
+    explicit Work_Stealing_Pool(size_t threads_num);
+    ~Work_Stealing_Pool();
+
+    Work_Stealing_Pool(const Work_Stealing_Pool&) = delete;
+    Work_Stealing_Pool& operator=(const Work_Stealing_Pool&) = delete;
+
+    size_t threads_num() const { return queues_.size(); }
+
+    void submit(Task_Group& group, std::function<void()> func);
+    void wait(Task_Group& group);
+};
+
+} //namespace geometry
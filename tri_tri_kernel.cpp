@@ -0,0 +1,434 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#include "tri_tri_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_X86_SIMD
+#endif
+
+namespace geometry {
+
+namespace {
+
+struct Point_2d {
+    double x;
+    double y;
+};
+
+//distances to lines of sides have one sign if p is inside,
+//points on sides with DOUBLE_GAP tolerance are inside too
+bool is_in_triangle_2d(const Triangle_Coords_2d& t, Point_2d p) noexcept {
+    bool is_left = true, is_right = true;
+    for(int i = 0; i < 3; ++i) {
+        double dist = (t.e[i][0] * (p.y - t.v[i][1]) - t.e[i][1] * (p.x - t.v[i][0])) / t.len[i];
+        if(dist < -DOUBLE_GAP) is_left = false;
+        if(dist > DOUBLE_GAP) is_right = false;
+    }
+    return is_left || is_right;
+}
+
+//cut p0-p1 and side of triangle
+bool is_cut_and_side_intersects_2d(Point_2d p0, Point_2d p1,
+                                   const Triangle_Coords_2d& t, int side) noexcept {
+    const double* q0 = t.v[side];
+    const double* q1 = t.v[(side + 1) % 3];
+    const double rx = p1.x - p0.x, ry = p1.y - p0.y;
+    const double sx = t.e[side][0], sy = t.e[side][1];
+    const double wx = q0[0] - p0.x, wy = q0[1] - p0.y;
+    const double r_len = sqrt(rx * rx + ry * ry);
+    const double s_len = t.len[side];
+    const double denom = rx * sy - ry * sx;
+
+    if(fabs(denom) < DOUBLE_GAP * r_len * s_len) {
+        //parallel cuts: only cuts on one line can touch
+        if(fabs(rx * wy - ry * wx) > DOUBLE_GAP * r_len) return false;
+
+        const double r_len2 = r_len * r_len;
+        double k0 = (wx * rx + wy * ry) / r_len2;
+        double k1 = ((q1[0] - p0.x) * rx + (q1[1] - p0.y) * ry) / r_len2;
+        return std::max(std::min(k0, k1), 0.0) <= std::min(std::max(k0, k1), 1.0);
+    }
+
+    //cuts touching by ends may miss each other by rounding error,
+    //so parameters are compared with DOUBLE_GAP tolerance along the cuts
+    double a = (wx * sy - wy * sx) / denom;
+    double b = (wx * ry - wy * rx) / denom;
+    const double a_gap = DOUBLE_GAP / r_len, b_gap = DOUBLE_GAP / s_len;
+    return (a >= -a_gap) && (a <= 1 + a_gap) && (b >= -b_gap) && (b <= 1 + b_gap);
+}
+
+//coordinates on the coordinate plane closest to the triangle plane,
+//the same choice as in is_cut_and_triangle_intersects_on_plane
+void projection_axes(const double pl[4], int& ax1, int& ax2) noexcept {
+    const double a = fabs(pl[0]), b = fabs(pl[1]), c = fabs(pl[2]);
+    if((a <= c) && (b <= c)) { ax1 = 0; ax2 = 1; }
+    else if((a <= b) && (c <= b)) { ax1 = 0; ax2 = 2; }
+    else { ax1 = 1; ax2 = 2; }
+}
+
+Triangle_Coords_2d project_triangle(const Triangle_Coords& t, int ax1, int ax2) noexcept {
+    Triangle_Coords_2d flat;
+    for(int i = 0; i < 3; ++i) {
+        flat.v[i][0] = t.v[i][ax1];
+        flat.v[i][1] = t.v[i][ax2];
+    }
+    for(int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        flat.e[i][0] = flat.v[j][0] - flat.v[i][0];
+        flat.e[i][1] = flat.v[j][1] - flat.v[i][1];
+        flat.len[i] = sqrt(flat.e[i][0] * flat.e[i][0] + flat.e[i][1] * flat.e[i][1]);
+    }
+    return flat;
+}
+
+bool is_cut_and_triangle_intersects_2d(const Triangle_Coords_2d& t,
+                                       Point_2d p0, Point_2d p1) noexcept {
+    if(is_in_triangle_2d(t, p0) || is_in_triangle_2d(t, p1)) return true;
+    for(int i = 0; i < 3; ++i) {
+        if(is_cut_and_side_intersects_2d(p0, p1, t, i)) return true;
+    }
+    return false;
+}
+
+bool is_triangles_intersects_2d(const Triangle_Coords_2d& t1,
+                                const Triangle_Coords_2d& t2) noexcept {
+    for(int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        if(is_cut_and_triangle_intersects_2d(t1, Point_2d{t2.v[i][0], t2.v[i][1]},
+                                             Point_2d{t2.v[j][0], t2.v[j][1]})) return true;
+    }
+    //t1 inside t2
+    return is_in_triangle_2d(t2, Point_2d{t1.v[0][0], t1.v[0][1]});
+}
+
+int side_by_distance(double dist) noexcept {
+    if(dist > DOUBLE_GAP) return 1;
+    if(dist < -DOUBLE_GAP) return -1;
+    return 0;
+}
+
+//signed distance in the same order as Plane::point_side_plane
+double plane_distance(const double pl[4], const double p[3]) noexcept {
+    return p[0] * pl[0] + p[1] * pl[1] + p[2] * pl[2] + pl[3];
+}
+
+bool is_triangle_on_one_side(const Triangle_Coords& t, const double pl[4]) noexcept {
+    int s[3];
+    for(int i = 0; i < 3; ++i) {
+        s[i] = side_by_distance(plane_distance(pl, t.v[i]));
+    }
+    return (s[0] * s[1] > 0) && (s[1] * s[2] > 0);
+}
+
+void check_packet_scalar(const Triangle_Coords& t, const Triangle_Cache& c,
+                         const Triangle_Coords* const* candidates,
+                         size_t count, uint8_t* results) noexcept {
+    for(size_t k = 0; k < count; ++k) {
+        results[k] = is_triangles_intersects(t, c, *candidates[k]) ? 1 : 0;
+    }
+}
+
+#ifdef GEOMETRY_X86_SIMD
+
+//sin^2 of angle between planes, or between their line and a side of t,
+//below which intervals on the line are unreliable
+const double PACKET_PARALLEL_SIN2 = 0.000001;
+//intervals must overlap by this length to intersect;
+//to be apart they must miss by 2 * PACKET_MARGIN / sin of the smallest angle between
+//the line and sides of t, because 2d checks take points closer than DOUBLE_GAP
+//to a side and so stretch t along a line which is almost parallel to the side
+const double PACKET_MARGIN = 16 * DOUBLE_GAP;
+
+typedef double v4d __attribute__((vector_size(32)));
+typedef double v8d __attribute__((vector_size(64)));
+
+//one code for every lanes number, it's inlined into functions
+//compiled for the needed instruction set;
+//distances are summed in the same order as in is_triangles_intersects
+template <typename V, int N>
+__attribute__((always_inline)) inline
+void check_lanes(const Triangle_Coords& t, const Triangle_Cache& c,
+                 const Triangle_Coords* const* candidates, uint8_t* results) noexcept {
+    using M = decltype(V() < V());
+
+    V u[3][3], u_pl[4];
+    for(int lane = 0; lane < N; ++lane) {
+        const Triangle_Coords& cand = *candidates[lane];
+        for(int i = 0; i < 3; ++i) {
+            for(int axis = 0; axis < 3; ++axis) {
+                u[i][axis][lane] = cand.v[i][axis];
+            }
+        }
+        for(int i = 0; i < 4; ++i) {
+            u_pl[i][lane] = cand.pl[i];
+        }
+    }
+
+    //signed distances: du - of candidates vertexes to t plane, dt - of t vertexes to candidates planes
+    V du[3], dt[3];
+    for(int i = 0; i < 3; ++i) {
+        du[i] = u[i][0] * t.pl[0] + u[i][1] * t.pl[1] + u[i][2] * t.pl[2] + t.pl[3];
+        dt[i] = t.v[i][0] * u_pl[0] + t.v[i][1] * u_pl[1] + t.v[i][2] * u_pl[2] + u_pl[3];
+    }
+
+    M is_separated = ((du[0] > DOUBLE_GAP) & (du[1] > DOUBLE_GAP) & (du[2] > DOUBLE_GAP)) |
+                     ((du[0] < -DOUBLE_GAP) & (du[1] < -DOUBLE_GAP) & (du[2] < -DOUBLE_GAP)) |
+                     ((dt[0] > DOUBLE_GAP) & (dt[1] > DOUBLE_GAP) & (dt[2] > DOUBLE_GAP)) |
+                     ((dt[0] < -DOUBLE_GAP) & (dt[1] < -DOUBLE_GAP) & (dt[2] < -DOUBLE_GAP));
+
+    M is_ambiguous = M() != M();
+    for(int i = 0; i < 3; ++i) {
+        is_ambiguous |= (du[i] <= DOUBLE_GAP) & (du[i] >= -DOUBLE_GAP);
+        is_ambiguous |= (dt[i] <= DOUBLE_GAP) & (dt[i] >= -DOUBLE_GAP);
+    }
+
+    //direction of planes intersection line
+    const V dx = t.pl[1] * u_pl[2] - t.pl[2] * u_pl[1];
+    const V dy = t.pl[2] * u_pl[0] - t.pl[0] * u_pl[2];
+    const V dz = t.pl[0] * u_pl[1] - t.pl[1] * u_pl[0];
+    const V d_len2 = dx * dx + dy * dy + dz * dz;
+    is_ambiguous |= d_len2 < PACKET_PARALLEL_SIN2;
+
+    //|d| * sin of the smallest angle between the line and sides of t
+    V d_sin = V() + INFINITY;
+    for(int i = 0; i < 3; ++i) {
+        const double* n = c.edge_normals[i];
+        const V d_n = dx * n[0] + dy * n[1] + dz * n[2];
+        const V abs_d_n = (d_n < 0) ? -d_n : d_n;
+        d_sin = (abs_d_n < d_sin) ? abs_d_n : d_sin;
+    }
+    is_ambiguous |= d_sin * d_sin < PACKET_PARALLEL_SIN2 * d_len2;
+
+    //interval of triangle on the line: its two sides which cross the other plane
+    auto interval = [&](const V (&dist)[3], const V (&proj)[3], V& low, V& high) {
+        const V inf = V() + INFINITY;
+        low = inf;
+        high = -inf;
+        const int edges[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+        for(const auto& edge : edges) {
+            const int i = edge[0], j = edge[1];
+            const M is_crossing = dist[i] * dist[j] < 0;
+            const V cross_p = proj[i] + (proj[j] - proj[i]) * (dist[i] / (dist[i] - dist[j]));
+            low = (is_crossing & (cross_p < low)) ? cross_p : low;
+            high = (is_crossing & (cross_p > high)) ? cross_p : high;
+        }
+    };
+
+    V proj_t[3], proj_u[3];
+    for(int i = 0; i < 3; ++i) {
+        proj_t[i] = dx * t.v[i][0] + dy * t.v[i][1] + dz * t.v[i][2];
+        proj_u[i] = dx * u[i][0] + dy * u[i][1] + dz * u[i][2];
+    }
+    V t_low, t_high, u_low, u_high;
+    interval(dt, proj_t, t_low, t_high);
+    interval(du, proj_u, u_low, u_high);
+
+    //projections are scaled by length of direction
+    const V overlap = (t_high < u_high ? t_high : u_high) - (t_low > u_low ? t_low : u_low);
+    const M is_intersects = (overlap > 0) & (overlap * overlap > PACKET_MARGIN * PACKET_MARGIN * d_len2);
+    const M is_apart = (overlap < 0) & (-overlap * d_sin > 2 * PACKET_MARGIN * d_len2);
+    is_ambiguous |= ~(is_intersects | is_apart);
+
+    for(int lane = 0; lane < N; ++lane) {
+        if(is_separated[lane]) results[lane] = 0;
+        else if(is_ambiguous[lane]) results[lane] = is_triangles_intersects(t, c, *candidates[lane]) ? 1 : 0;
+        else results[lane] = is_intersects[lane] ? 1 : 0;
+    }
+}
+
+__attribute__((target("avx2")))
+void check_packet_avx2(const Triangle_Coords& t, const Triangle_Cache& c,
+                       const Triangle_Coords* const* candidates,
+                       size_t count, uint8_t* results) noexcept {
+    size_t k = 0;
+    for(; k + 4 <= count; k += 4) {
+        check_lanes<v4d, 4>(t, c, candidates + k, results + k);
+    }
+    check_packet_scalar(t, c, candidates + k, count - k, results + k);
+}
+
+__attribute__((target("avx512f")))
+void check_packet_avx512(const Triangle_Coords& t, const Triangle_Cache& c,
+                         const Triangle_Coords* const* candidates,
+                         size_t count, uint8_t* results) noexcept {
+    size_t k = 0;
+    for(; k + 8 <= count; k += 8) {
+        check_lanes<v8d, 8>(t, c, candidates + k, results + k);
+    }
+    check_packet_avx2(t, c, candidates + k, count - k, results + k);
+}
+
+#endif //GEOMETRY_X86_SIMD
+
+} //namespace
+
+Triangle_Coords make_triangle_coords(const Triangle& t) noexcept {
+    Triangle_Coords coords;
+    const point* vertexes[3] = {&t.p1(), &t.p2(), &t.p3()};
+    for(int i = 0; i < 3; ++i) {
+        coords.v[i][0] = vertexes[i]->x();
+        coords.v[i][1] = vertexes[i]->y();
+        coords.v[i][2] = vertexes[i]->z();
+    }
+    coords.pl[0] = t.pl().A();
+    coords.pl[1] = t.pl().B();
+    coords.pl[2] = t.pl().C();
+    coords.pl[3] = t.pl().D();
+    return coords;
+}
+
+Triangle_Cache make_triangle_cache(const Triangle_Coords& t) noexcept {
+    Triangle_Cache c;
+    for(int i = 0; i < 3; ++i) {
+        c.box.extend(Bounding_Box(point(t.v[i][0], t.v[i][1], t.v[i][2])));
+    }
+
+    for(int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        double e[3];
+        for(int axis = 0; axis < 3; ++axis) {
+            e[axis] = t.v[j][axis] - t.v[i][axis];
+        }
+        //normal of plane x side, it looks inside for one orientation of vertexes
+        //and outside for the other one
+        double* n = c.edge_normals[i];
+        n[0] = t.pl[1] * e[2] - t.pl[2] * e[1];
+        n[1] = t.pl[2] * e[0] - t.pl[0] * e[2];
+        n[2] = t.pl[0] * e[1] - t.pl[1] * e[0];
+        const double len = sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+        for(int axis = 0; axis < 3; ++axis) {
+            n[axis] /= len;
+        }
+    }
+
+    projection_axes(t.pl, c.ax1, c.ax2);
+    c.flat = project_triangle(t, c.ax1, c.ax2);
+    return c;
+}
+
+bool is_triangles_intersects(const Triangle_Coords& t1, const Triangle_Coords& t2) noexcept {
+    return is_triangles_intersects(t1, make_triangle_cache(t1), t2);
+}
+
+bool is_triangles_intersects(const Triangle_Coords& t1, const Triangle_Cache& c1,
+                             const Triangle_Coords& t2) noexcept {
+    //signed distances of t2 vertexes to t1 plane
+    double d2[3];
+    int s2[3];
+    for(int i = 0; i < 3; ++i) {
+        d2[i] = plane_distance(t1.pl, t2.v[i]);
+        s2[i] = side_by_distance(d2[i]);
+    }
+    if((s2[0] * s2[1] > 0) && (s2[1] * s2[2] > 0)) return false;
+    if(is_triangle_on_one_side(t1, t2.pl)) return false;
+
+    const int ax1 = c1.ax1, ax2 = c1.ax2;
+    if((s2[0] == 0) && (s2[1] == 0) && (s2[2] == 0)) {
+        return is_triangles_intersects_2d(c1.flat, project_triangle(t2, ax1, ax2));
+    }
+
+    //t2 crosses t1 plane by a cut or touches it by a vertex
+    Point_2d cut[2];
+    int cut_size = 0;
+    const int edges[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+    for(const auto& edge : edges) {
+        const int i = edge[0], j = edge[1];
+        if(s2[i] * s2[j] >= 0) continue;
+        const double k = d2[i] / (d2[i] - d2[j]);
+        cut[cut_size++] = Point_2d{t2.v[i][ax1] + k * (t2.v[j][ax1] - t2.v[i][ax1]),
+                                   t2.v[i][ax2] + k * (t2.v[j][ax2] - t2.v[i][ax2])};
+    }
+    for(int i = 0; (i < 3) && (cut_size < 2); ++i) {
+        if(s2[i] == 0) cut[cut_size++] = Point_2d{t2.v[i][ax1], t2.v[i][ax2]};
+    }
+
+    if(cut_size == 1) return is_in_triangle_2d(c1.flat, cut[0]);
+    return is_cut_and_triangle_intersects_2d(c1.flat, cut[0], cut[1]);
+}
+
+bool is_triangle_and_cut_intersects(const Triangle_Coords& t, const Triangle_Cache& c,
+                                    const double begin[3], const double end[3]) noexcept {
+    const double d0 = plane_distance(t.pl, begin);
+    const double d1 = plane_distance(t.pl, end);
+    const int s0 = side_by_distance(d0), s1 = side_by_distance(d1);
+    if(s0 * s1 > 0) return false;
+
+    if((s0 == 0) && (s1 == 0)) {
+        return is_cut_and_triangle_intersects_2d(c.flat, Point_2d{begin[c.ax1], begin[c.ax2]},
+                                                 Point_2d{end[c.ax1], end[c.ax2]});
+    }
+    if(s0 == 0) return is_triangle_and_point_intersects(t, c, begin);
+    if(s1 == 0) return is_triangle_and_point_intersects(t, c, end);
+
+    const double k = d0 / (d0 - d1);
+    double p[3];
+    for(int axis = 0; axis < 3; ++axis) {
+        p[axis] = begin[axis] + k * (end[axis] - begin[axis]);
+    }
+    return is_triangle_and_point_intersects(t, c, p);
+}
+
+bool is_triangle_and_point_intersects(const Triangle_Coords& t, const Triangle_Cache& c,
+                                      const double p[3]) noexcept {
+    if(fabs(plane_distance(t.pl, p)) >= DOUBLE_GAP) return false;
+
+    //signed distances from p to lines of sides: they have one sign if p is inside
+    bool is_left = true, is_right = true;
+    for(int i = 0; i < 3; ++i) {
+        const double* n = c.edge_normals[i];
+        double dist = (p[0] - t.v[i][0]) * n[0] + (p[1] - t.v[i][1]) * n[1] +
+                      (p[2] - t.v[i][2]) * n[2];
+        if(dist < -DOUBLE_GAP) is_left = false;
+        if(dist > DOUBLE_GAP) is_right = false;
+    }
+    return is_left || is_right;
+}
+
+plane_test_result triangles_plane_test(const Triangle_Coords& t1, const Triangle_Coords& t2) noexcept {
+    if(is_triangle_on_one_side(t2, t1.pl)) return FIRST_PLANE_REJECT;
+    if(is_triangle_on_one_side(t1, t2.pl)) return SECOND_PLANE_REJECT;
+    return NO_PLANE_REJECT;
+}
+
+plane_test_result triangle_and_cut_plane_test(const Triangle_Coords& t,
+                                              const double begin[3], const double end[3]) noexcept {
+    const int s0 = side_by_distance(plane_distance(t.pl, begin));
+    const int s1 = side_by_distance(plane_distance(t.pl, end));
+    return (s0 * s1 > 0) ? FIRST_PLANE_REJECT : NO_PLANE_REJECT;
+}
+
+plane_test_result triangle_and_point_plane_test(const Triangle_Coords& t, const double p[3]) noexcept {
+    return (fabs(plane_distance(t.pl, p)) >= DOUBLE_GAP) ? FIRST_PLANE_REJECT : NO_PLANE_REJECT;
+}
+
+void is_triangles_intersects_packet(const Triangle_Coords& t, const Triangle_Cache& c,
+                                    const Triangle_Coords* const* candidates,
+                                    size_t count, uint8_t* results) noexcept {
+    //8 lanes of AVX-512 were slower than 4 lanes in measurements:
+    //packing of candidates into wide registers costs more than it saves
+    const simd_level level = std::min(best_simd_level(), AVX2_SIMD);
+    is_triangles_intersects_packet(t, c, candidates, count, results, level);
+}
+
+void is_triangles_intersects_packet(const Triangle_Coords& t, const Triangle_Cache& c,
+                                    const Triangle_Coords* const* candidates,
+                                    size_t count, uint8_t* results, simd_level level) noexcept {
+    switch(level) {
+#ifdef GEOMETRY_X86_SIMD
+    case AVX512_SIMD:
+        check_packet_avx512(t, c, candidates, count, results);
+        return;
+    case AVX2_SIMD:
+        check_packet_avx2(t, c, candidates, count, results);
+        return;
+#endif
+    default:
+        //two lanes of SSE2 don't pay for packing
+        check_packet_scalar(t, c, candidates, count, results);
+    }
+}
+
+} //namespace geometry
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "geometry.h"
+#include "simd_level.h"
+
+namespace geometry {
+
+//---------------------------------------Tri_Tri_Kernel----------------------------
+
+//Raw triangle for the narrow phase kernel, it's filled from Triangle or record
+struct Triangle_Coords {
+    double v[3][3];  //[vertex][axis]
+    double pl[4];    //A, B, C, D of triangle plane, normal is normalized
+};
+
+Triangle_Coords make_triangle_coords(const Triangle& t) noexcept;
+
+//Projection of triangle to the coordinate plane closest to its plane
+struct Triangle_Coords_2d {
+    double v[3][2];  //[vertex][coordinate]
+    double e[3][2];  //sides, side i goes from vertex i to vertex i + 1
+    double len[3];   //lengths of sides
+};
+
+//Data which depends only on one triangle, it's computed once per triangle
+//and reused in every check of this triangle with other objects
+struct Triangle_Cache {
+    Bounding_Box box;
+    double edge_normals[3][3];  //unit normals to sides in triangle plane, side i ends at vertex i + 1
+    int ax1, ax2;               //coordinates left in projection, dominant axis of normal is dropped
+    Triangle_Coords_2d flat;
+};
+
+Triangle_Cache make_triangle_cache(const Triangle_Coords& t) noexcept;
+
+//triangle with its cache, stored or query one
+struct Cached_Triangle {
+    const Triangle_Coords& coords;
+    const Triangle_Cache& cache;
+};
+
+//Triangle-triangle test which never allocates or throws.
+//Signed distances of vertexes to the other plane are computed once:
+//they give the early-outs, coplanar case and the points where t2 crosses t1 plane,
+//then segment of t2 on t1 plane is checked with t1 in 2d.
+//Objects closer than DOUBLE_GAP intersect, as in other checks.
+bool is_triangles_intersects(const Triangle_Coords& t1, const Triangle_Coords& t2) noexcept;
+//c1 is the cache of t1, only t1 is projected to 2d
+bool is_triangles_intersects(const Triangle_Coords& t1, const Triangle_Cache& c1,
+                             const Triangle_Coords& t2) noexcept;
+
+//cut is given by its ends, it crosses the plane or lies on it
+bool is_triangle_and_cut_intersects(const Triangle_Coords& t, const Triangle_Cache& c,
+                                    const double begin[3], const double end[3]) noexcept;
+bool is_triangle_and_point_intersects(const Triangle_Coords& t, const Triangle_Cache& c,
+                                      const double p[3]) noexcept;
+
+//Plane early-outs of the checks above alone, for statistics:
+//which plane separates objects, plane of t (t1) is the first one
+enum plane_test_result {NO_PLANE_REJECT, FIRST_PLANE_REJECT, SECOND_PLANE_REJECT};
+
+plane_test_result triangles_plane_test(const Triangle_Coords& t1, const Triangle_Coords& t2) noexcept;
+plane_test_result triangle_and_cut_plane_test(const Triangle_Coords& t,
+                                              const double begin[3], const double end[3]) noexcept;
+plane_test_result triangle_and_point_plane_test(const Triangle_Coords& t, const double p[3]) noexcept;
+
+//One triangle against candidates in vector lanes, 4 (AVX2) or 8 (AVX-512) at once:
+//separating plane early-outs and overlap of both triangles intervals on the line
+//where planes intersect. Coplanar lanes, lanes with vertexes on the other plane,
+//lanes where the line is almost parallel to a side of t and lanes where intervals
+//neither clearly overlap nor clearly miss (the margin grows as the line turns
+//to a side of t) are given to is_triangles_intersects,
+//so results[k] is is_triangles_intersects(t, *candidates[k]) as 0 or 1.
+void is_triangles_intersects_packet(const Triangle_Coords& t, const Triangle_Cache& c,
+                                    const Triangle_Coords* const* candidates,
+                                    size_t count, uint8_t* results) noexcept;
+//level must be supported by processor
+void is_triangles_intersects_packet(const Triangle_Coords& t, const Triangle_Cache& c,
+                                    const Triangle_Coords* const* candidates,
+                                    size_t count, uint8_t* results, simd_level level) noexcept;
+
+} //namespace geometry
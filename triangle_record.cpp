@@ -0,0 +1,99 @@
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "triangle_record.h"
+
+namespace geometry {
+
+namespace {
+
+int point_side(const Plane& pl, double x, double y, double z) {
+    double k = x * pl.A() + y * pl.B() + z * pl.C() + pl.D();
+    if(k > DOUBLE_GAP) return 1;
+    if(k < -DOUBLE_GAP) return -1;
+    return 0;
+}
+
+int triangle_side(int i1, int i2, int i3) {
+    if((i1 == 1) && (i2 == 1) && (i3 == 1)) return 1;
+    if((i1 == -1) && (i2 == -1) && (i3 == -1)) return -1;
+    return 0;
+}
+
+} //namespace
+
+//--------------------------------------Triangle_Record----------------------------
+
+Triangle_Record::Triangle_Record(const Triangle& t, size_t number):
+    coords_(make_triangle_coords(t))
+{
+    if(number > UINT32_MAX) throw std::invalid_argument("Triangle number doesn't fit in record");
+    number_ = static_cast<uint32_t>(number);
+}
+
+Bounding_Box Triangle_Record::box() const {
+    Bounding_Box box(p1());
+    box.extend(Bounding_Box(p2()));
+    box.extend(Bounding_Box(p3()));
+    return box;
+}
+
+int Triangle_Record::side_plane(const Plane& pl) const {
+    const double (&v)[3][3] = coords_.v;
+    return triangle_side(point_side(pl, v[0][0], v[0][1], v[0][2]),
+                         point_side(pl, v[1][0], v[1][1], v[1][2]),
+                         point_side(pl, v[2][0], v[2][1], v[2][2]));
+}
+
+
+
+
+//--------------------------------------Scalar_Triangles---------------------------
+
+template <typename Scalar>
+Scalar_Triangles<Scalar>::Scalar_Triangles(const std::vector<Triangle_Record>& records,
+                                           bool is_recentred):
+    origin_{0, 0, 0}, extent_(0)
+{
+    if(is_recentred && !records.empty()) {
+        Bounding_Box box;
+        for(const Triangle_Record& t : records) box.extend(t.box());
+        for(int axis = 0; axis < 3; ++axis) origin_[axis] = box.center(axis);
+    }
+
+    triangles_.reserve(records.size());
+    for(const Triangle_Record& t : records) {
+        Scalar_Triangle<Scalar> copy;
+        for(int vertex = 0; vertex < 3; ++vertex) {
+            for(int axis = 0; axis < 3; ++axis) {
+                const double coord = t.coord(vertex, axis) - origin_[axis];
+                extent_ = std::max(extent_, fabs(coord));
+                copy.v[vertex][axis] = static_cast<Scalar>(coord);
+            }
+        }
+        triangles_.push_back(copy);
+    }
+}
+
+template <typename Scalar>
+Scalar_Plane<Scalar> Scalar_Triangles<Scalar>::plane(const Plane& pl) const {
+    const double d = pl.D() + pl.A() * origin_[0] + pl.B() * origin_[1] + pl.C() * origin_[2];
+
+    //rounding of coordinates, coefficients and every operation of distance is bounded
+    //by epsilon of the biggest term: |A x + B y + C z| <= 2 * extent for unit normal
+    const double epsilon = std::numeric_limits<Scalar>::epsilon();
+    const double gap = DOUBLE_GAP + 8 * epsilon * (2 * extent_ + fabs(d));
+    return Scalar_Plane<Scalar>{static_cast<Scalar>(pl.A()), static_cast<Scalar>(pl.B()),
+                                static_cast<Scalar>(pl.C()), static_cast<Scalar>(d),
+                                static_cast<Scalar>(gap)};
+}
+
+template class Scalar_Triangles<float>;
+template class Scalar_Triangles<double>;
+
+} //namespace geometry
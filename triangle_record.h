@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+#include "geometry.h"
+#include "tri_tri_kernel.h"
+
+namespace geometry {
+
+//--------------------------------------Triangle_Record----------------------------
+
+//Compact triangle for storages of millions of objects: 9 coordinates,
+//plane coefficients and 32-bit number without any virtual tables.
+//Triangle for narrow phase is made from record when it's needed.
+class Triangle_Record final {
+private:
+    Triangle_Coords coords_;
+    uint32_t number_;
+public:
+    Triangle_Record(const Triangle& t, size_t number);
+
+    size_t number() const { return number_; }
+    const Triangle_Coords& coords() const { return coords_; }
+    double coord(int vertex, int axis) const { return coords_.v[vertex][axis]; }
+    point vertex(int num) const {
+        return point(coords_.v[num][0], coords_.v[num][1], coords_.v[num][2]);
+    }
+    point p1() const { return vertex(0); }
+    point p2() const { return vertex(1); }
+    point p3() const { return vertex(2); }
+    Plane pl() const { return Plane(coords_.pl[0], coords_.pl[1], coords_.pl[2], coords_.pl[3]); }
+
+    Triangle triangle() const { return Triangle(p1(), p2(), p3(), pl()); }
+    Bounding_Box box() const;
+
+    //the same result as Plane::triangle_side_plane for triangle()
+    int side_plane(const Plane& pl) const;
+};
+
+static_assert(std::is_trivially_copyable<Triangle_Record>::value,
+              "triangle records are copied as raw memory");
+
+
+
+
+//--------------------------------------Scalar_Triangles---------------------------
+
+//Vertexes of triangle in Scalar coordinates, relative to origin of its Scalar_Triangles
+template <typename Scalar>
+struct Scalar_Triangle {
+    Scalar v[3][3];  //[vertex][axis]
+};
+
+//Plane in coordinates of the same origin, distances closer than gap to zero are crossing
+template <typename Scalar>
+struct Scalar_Plane {
+    Scalar a, b, c, d;
+    Scalar gap;
+};
+
+//Copies of stored triangles for classification by split planes in Scalar (float copy
+//is a third of records size). Coordinates are rounded to Scalar, so tolerance of sides
+//grows with distance from origin: gap is DOUBLE_GAP plus error bound of Scalar distance,
+//and every triangle which is on one side in Scalar is on this side for double planes too.
+//If origin is the center of triangles, small objects far from zero keep their precision.
+template <typename Scalar>
+class Scalar_Triangles final {
+private:
+    double origin_[3];
+    double extent_;  //the biggest coordinate relative to origin
+    std::vector<Scalar_Triangle<Scalar>> triangles_;
+public:
+    //triangles()[i] is the copy of records[i]
+    Scalar_Triangles(const std::vector<Triangle_Record>& records, bool is_recentred);
+
+    const std::vector<Scalar_Triangle<Scalar>>& triangles() const { return triangles_; }
+    double extent() const { return extent_; }
+
+    Scalar_Plane<Scalar> plane(const Plane& pl) const;
+};
+
+//sides are evaluated in the same order as in Plane::point_side_plane
+template <typename Scalar>
+int triangle_side_plane(const Scalar_Plane<Scalar>& pl, const Scalar_Triangle<Scalar>& t) {
+    int side = 0;
+    for(int vertex = 0; vertex < 3; ++vertex) {
+        const Scalar k = t.v[vertex][0] * pl.a + t.v[vertex][1] * pl.b + t.v[vertex][2] * pl.c + pl.d;
+        const int vertex_side = (k > pl.gap) ? 1 : ((k < -pl.gap) ? -1 : 0);
+        if((vertex_side == 0) || ((vertex > 0) && (vertex_side != side))) return 0;
+        side = vertex_side;
+    }
+    return side;
+}
+
+} //namespace geometry
@@ -0,0 +1,180 @@
+#include <cstdlib>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "uniform_grid.h"
+
+namespace geometry {
+
+Uniform_Grid::Uniform_Grid(std::vector<Bounding_Box> boxes):
+    boxes_(std::move(boxes)),
+    is_oversized_(boxes_.size(), false),
+    oversized_tree_(std::vector<Bounding_Box>{})
+{
+    if(boxes_.empty()) return;
+
+    std::vector<double> extents;
+    extents.reserve(boxes_.size());
+    for(const Bounding_Box& box : boxes_) {
+        scene_box_.extend(box);
+        extents.push_back(box.extent(box.largest_axis()));
+    }
+
+    auto median = extents.begin() + extents.size() / 2;
+    std::nth_element(extents.begin(), median, extents.end());
+    cell_size_ = *median;
+
+    //cell coordinates must fit into packed key
+    const double max_cells = static_cast<double>((int64_t(1) << KEY_BITS) - 1);
+    for(int axis = 0; axis < 3; ++axis) {
+        cell_size_ = std::max(cell_size_, scene_box_.extent(axis) / max_cells);
+    }
+    if(cell_size_ <= 0) cell_size_ = 1;
+
+    entries_.reserve(boxes_.size() * 8);
+    for(size_t i = 0; i < boxes_.size(); ++i) {
+        const Bounding_Box& box = boxes_[i];
+        int64_t low[3], high[3];
+        size_t cells_num = 1;
+        for(int axis = 0; axis < 3; ++axis) {
+            low[axis] = cell_coord(box.low(axis), axis);
+            high[axis] = cell_coord(box.high(axis), axis);
+            cells_num *= static_cast<size_t>(high[axis] - low[axis] + 1);
+        }
+
+        if(cells_num > MAX_CELLS_PER_OBJECT) {
+            oversized_.push_back(i);
+            is_oversized_[i] = true;
+            continue;
+        }
+
+        for(int64_t x = low[0]; x <= high[0]; ++x) {
+            for(int64_t y = low[1]; y <= high[1]; ++y) {
+                for(int64_t z = low[2]; z <= high[2]; ++z) {
+                    entries_.push_back(Cell_Entry{cell_key(x, y, z), i});
+                }
+            }
+        }
+    }
+
+    std::sort(entries_.begin(), entries_.end(), [](const Cell_Entry& e1, const Cell_Entry& e2) {
+        if(e1.key != e2.key) return e1.key < e2.key;
+        return e1.obj_num < e2.obj_num;
+    });
+
+    std::vector<Bounding_Box> oversized_boxes;
+    oversized_boxes.reserve(oversized_.size());
+    for(size_t obj : oversized_) {
+        oversized_boxes.push_back(boxes_[obj]);
+    }
+    oversized_tree_ = BVH_Tree(std::move(oversized_boxes));
+
+    for(size_t i = 0; i < entries_.size(); ++i) {
+        if((i == 0) || (entries_[i].key != entries_[i - 1].key)) cell_begins_.push_back(i);
+    }
+    cell_begins_.push_back(entries_.size());
+}
+
+int64_t Uniform_Grid::cell_coord(double coord, int axis) const {
+    const int64_t max_coord = (int64_t(1) << KEY_BITS) - 1;
+    int64_t c = static_cast<int64_t>(floor((coord - scene_box_.low(axis)) / cell_size_));
+    return std::min(std::max(c, int64_t(0)), max_coord);
+}
+
+uint64_t Uniform_Grid::cell_key(int64_t x, int64_t y, int64_t z) const {
+    return (static_cast<uint64_t>(x) << (2 * KEY_BITS)) |
+           (static_cast<uint64_t>(y) << KEY_BITS) |
+            static_cast<uint64_t>(z);
+}
+
+bool Uniform_Grid::is_pair_owner(size_t obj1, size_t obj2, uint64_t key) const {
+    const Bounding_Box& b1 = boxes_[obj1];
+    const Bounding_Box& b2 = boxes_[obj2];
+    int64_t c[3];
+    for(int axis = 0; axis < 3; ++axis) {
+        c[axis] = cell_coord(std::max(b1.low(axis), b2.low(axis)), axis);
+    }
+    return cell_key(c[0], c[1], c[2]) == key;
+}
+
+void Uniform_Grid::collide_cells(size_t cell_begin, size_t cell_end,
+                                 const Pair_Callback& func) const {
+    for(size_t cell = cell_begin; cell < cell_end; ++cell) {
+        const size_t begin = cell_begins_[cell];
+        const size_t end = cell_begins_[cell + 1];
+        const uint64_t key = entries_[begin].key;
+
+        for(size_t i = begin; i < end; ++i) {
+            const size_t obj1 = entries_[i].obj_num;
+            for(size_t j = i + 1; j < end; ++j) {
+                const size_t obj2 = entries_[j].obj_num;
+                if(is_boxes_intersects(boxes_[obj1], boxes_[obj2]) == false) continue;
+                if(is_pair_owner(obj1, obj2, key) == false) continue;
+                func(obj1, obj2);
+            }
+        }
+    }
+}
+
+void Uniform_Grid::collide_oversized(size_t obj_begin, size_t obj_end,
+                                     const Pair_Callback& func) const {
+    for(size_t obj = obj_begin; obj < obj_end; ++obj) {
+        if(is_oversized_[obj]) continue; //pairs of two big ones are met in collide_oversized_self
+        oversized_tree_.for_each_overlapping_object(boxes_[obj], [this, obj, &func](size_t big) {
+            func(oversized_[big], obj);
+            return true;
+        });
+    }
+}
+
+void Uniform_Grid::collide_oversized_self(const Pair_Callback& func,
+                                          Work_Stealing_Pool* pool, size_t sequential_cutoff) const {
+    oversized_tree_.for_each_overlapping_pair([this, &func](size_t big1, size_t big2) {
+        func(oversized_[big1], oversized_[big2]);
+    }, pool, sequential_cutoff);
+}
+
+void Uniform_Grid::for_each_overlapping_pair(const Pair_Callback& func,
+                                             Work_Stealing_Pool* pool,
+                                             size_t sequential_cutoff) const {
+    const size_t cells = cells_num();
+    //every object is checked with oversized ones, when there are any
+    const size_t work = entries_.size() + (oversized_.empty() ? 0 : boxes_.size());
+
+    if((pool == nullptr) || (work < sequential_cutoff) || (sequential_cutoff == 0)) {
+        collide_cells(0, cells, func);
+        if(oversized_.empty()) return;
+        collide_oversized(0, boxes_.size(), func);
+        collide_oversized_self(func, nullptr, 0);
+        return;
+    }
+
+    //chunks of neighbouring cells with about sequential_cutoff entries each
+    Task_Group group;
+    size_t chunk_begin = 0;
+    for(size_t cell = 0; cell < cells; ++cell) {
+        if((cell_begins_[cell + 1] - cell_begins_[chunk_begin] < sequential_cutoff) &&
+           (cell + 1 < cells)) {
+            continue;
+        }
+        pool->submit(group, [this, chunk_begin, cell, &func]() {
+            collide_cells(chunk_begin, cell + 1, func);
+        });
+        chunk_begin = cell + 1;
+    }
+    //every object asks small tree of oversized ones, chunks of objects run like cells
+    if(!oversized_.empty()) {
+        for(size_t obj_begin = 0; obj_begin < boxes_.size(); obj_begin += sequential_cutoff) {
+            const size_t obj_end = std::min(obj_begin + sequential_cutoff, boxes_.size());
+            pool->submit(group, [this, obj_begin, obj_end, &func]() {
+                collide_oversized(obj_begin, obj_end, func);
+            });
+        }
+        collide_oversized_self(func, pool, sequential_cutoff);
+    }
+    pool->wait(group);
+}
+
+} //namespace geometry
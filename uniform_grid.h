@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "bvh.h"
+#include "geometry.h"
+#include "thread_pool.h"
+
+namespace geometry {
+
+//---------------------------------------Uniform_Grid------------------------------
+
+//Hashed uniform grid over boxes of objects, cell size is the median box extent.
+//Fits scenes of many small objects spread evenly, when most boxes touch few cells.
+//Object numbers in callbacks are indexes in the boxes array given to constructor.
+class Uniform_Grid final {
+public:
+    using Pair_Callback = std::function<void(size_t, size_t)>;
+private:
+    static const size_t MAX_CELLS_PER_OBJECT = 64; //bigger objects are kept in small BVH
+    static const int KEY_BITS = 21;                //cell coordinate bits in packed key
+
+    struct Cell_Entry {
+        uint64_t key;
+        size_t obj_num;
+    };
+
+    std::vector<Bounding_Box> boxes_;
+    Bounding_Box scene_box_;
+    double cell_size_ = 0;
+    std::vector<Cell_Entry> entries_;   //sorted by key, equal keys make one cell
+    std::vector<size_t> cell_begins_;   //entries_ indexes where cells begin, last is entries_.size()
+    std::vector<size_t> oversized_;     //objects which cover too many cells
+    std::vector<bool> is_oversized_;
+    BVH_Tree oversized_tree_;           //boxes of oversized_ objects in their order
+
+    int64_t cell_coord(double coord, int axis) const;
+    uint64_t cell_key(int64_t x, int64_t y, int64_t z) const;
+    bool is_pair_owner(size_t obj1, size_t obj2, uint64_t key) const;
+    void collide_cells(size_t cell_begin, size_t cell_end, const Pair_Callback& func) const;
+    void collide_oversized(size_t obj_begin, size_t obj_end, const Pair_Callback& func) const;
+    void collide_oversized_self(const Pair_Callback& func,
+                                Work_Stealing_Pool* pool, size_t sequential_cutoff) const;
+public:
+    Uniform_Grid(std::vector<Bounding_Box> boxes);
+
+    double cell_size() const { return cell_size_; }
+    size_t cells_num() const { return cell_begins_.empty() ? 0 : cell_begins_.size() - 1; }
+
+    //calls func once for every unordered pair of objects with intersecting boxes:
+    //pair sharing several cells is reported only from the cell
+    //which contains low corner of boxes intersection
+    void for_each_overlapping_pair(const Pair_Callback& func,
+                                   Work_Stealing_Pool* pool = nullptr,
+                                   size_t sequential_cutoff = 0) const;
+};
+
+} //namespace geometry
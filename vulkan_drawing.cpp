@@ -1522,13 +1522,13 @@ int draw_triangles_driver(geometry::Objects_and_Intersections objects_for_draw)
     std::vector<Vertex> vertices;
     std::vector<uint16_t> indices; //don't touch the type (uint16_t)!
 
-    const std::vector<geometry::Object_Triangle>& triangles = objects_for_draw.triangles();
+    const std::vector<geometry::Triangle_Record>& triangles = objects_for_draw.triangles();
     const std::vector<bool>& intersection_flags = objects_for_draw.intersection_flags();
 
     vertices.reserve(triangles.size() * 3);
     indices.reserve(triangles.size() * 6);
 
-    for(const geometry::Object_Triangle& elem : triangles) {
+    for(const geometry::Triangle_Record& elem : triangles) {
 
         glm::vec3 color;
         if(intersection_flags[elem.number()] == true) {